@@ -0,0 +1,72 @@
+// Batch completion vs. per-call set_value.
+//
+// Completes 512 OneShot<int> senders per round, either with a set_value loop
+// or with OneShot<int>::complete_batch, with no waiters and with a handful of
+// consumer threads blocked on part of the batch. Prints ns per completion.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "OneShotFuture.hpp"
+
+namespace {
+
+constexpr int kBatch = 512;
+constexpr int kRounds = 2000;
+constexpr int kBlockedConsumers = 4;
+
+struct Round {
+    std::vector<OneShot<int>::Sender> senders;
+    std::vector<OneShot<int>::Receiver> receivers;
+    std::vector<int> values;
+
+    Round() {
+        for (int i = 0; i < kBatch; ++i) {
+            auto [s, r] = OneShot<int>::make();
+            senders.push_back(std::move(s));
+            receivers.push_back(std::move(r));
+            values.push_back(i);
+        }
+    }
+};
+
+template<typename Complete>
+double run(bool with_waiters, Complete&& complete) {
+    std::chrono::nanoseconds total{0};
+    for (int round = 0; round < kRounds; ++round) {
+        Round rd;
+        std::vector<std::thread> consumers;
+        if (with_waiters) {
+            std::atomic<int> parked{0};
+            for (int c = 0; c < kBlockedConsumers; ++c) {
+                consumers.emplace_back([&rd, &parked, c]() {
+                    parked++;
+                    rd.receivers[c * (kBatch / kBlockedConsumers)].get();
+                });
+            }
+            while (parked.load() < kBlockedConsumers) std::this_thread::yield();
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        auto start = std::chrono::steady_clock::now();
+        complete(rd);
+        total += std::chrono::steady_clock::now() - start;
+        for (auto& t : consumers) t.join();
+    }
+    return static_cast<double>(total.count()) / (double(kRounds) * kBatch);
+}
+
+} // namespace
+
+int main() {
+    auto loop = [](Round& rd) {
+        for (int i = 0; i < kBatch; ++i) rd.senders[i].set_value(rd.values[i]);
+    };
+    auto batch = [](Round& rd) { OneShot<int>::complete_batch(rd.senders, rd.values); };
+
+    std::printf("%-34s %10s\n", "case", "ns/completion");
+    std::printf("%-34s %10.1f\n", "set_value loop, no waiters", run(false, loop));
+    std::printf("%-34s %10.1f\n", "complete_batch, no waiters", run(false, batch));
+    std::printf("%-34s %10.1f\n", "set_value loop, 4 blocked", run(true, loop));
+    std::printf("%-34s %10.1f\n", "complete_batch, 4 blocked", run(true, batch));
+}
@@ -0,0 +1,133 @@
+// Channel<int> (Vyukov ring) vs. a bounded mutex + std::deque queue.
+//
+// P producers send kItems values in total through a queue of capacity
+// kCapacity to C consumers; both queues block when full or empty. Channel is
+// also run with send_batch / receive_batch of kBatch values. Prints millions
+// of items per second.
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BoundedChannel.hpp"
+
+namespace {
+
+constexpr int kItems = 1 << 20;
+constexpr std::size_t kCapacity = 1024;
+constexpr std::size_t kBatch = 32;
+
+class MutexQueue {
+    std::mutex mtx_;
+    std::condition_variable not_empty_, not_full_;
+    std::deque<int> items_;
+    int producers_;
+
+public:
+    explicit MutexQueue(int producers) : producers_(producers) {}
+
+    void send(int v) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_full_.wait(lock, [&] { return items_.size() < kCapacity; });
+        items_.push_back(v);
+        lock.unlock();
+        not_empty_.notify_one();
+    }
+
+    bool receive(int& v) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_empty_.wait(lock, [&] { return !items_.empty() || producers_ == 0; });
+        if (items_.empty()) return false;
+        v = items_.front();
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void producer_done() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (--producers_ == 0) not_empty_.notify_all();
+    }
+};
+
+template<typename Produce, typename Consume>
+double run(int producers, int consumers, Produce&& produce, Consume&& consume) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < consumers; ++c) threads.emplace_back([&, c] { consume(c); });
+    for (int p = 0; p < producers; ++p) threads.emplace_back([&, p] { produce(p); });
+    for (auto& t : threads) t.join();
+    std::chrono::duration<double> s = std::chrono::steady_clock::now() - start;
+    return kItems / s.count() / 1e6;
+}
+
+double mutex_deque(int producers, int consumers) {
+    MutexQueue q(producers);
+    return run(
+        producers, consumers,
+        [&](int) {
+            for (int i = 0; i < kItems / producers; ++i) q.send(i);
+            q.producer_done();
+        },
+        [&](int) {
+            int v;
+            while (q.receive(v)) {
+            }
+        });
+}
+
+double channel(int producers, int consumers) {
+    auto [tx, rx] = Channel<int>::make(kCapacity);
+    std::vector<Channel<int>::Sender> txs(producers, tx);
+    std::vector<Channel<int>::Receiver> rxs(consumers, rx);
+    tx = {};
+    rx = {};
+    return run(
+        producers, consumers,
+        [&](int p) {
+            for (int i = 0; i < kItems / producers; ++i) txs[p].send(i);
+            txs[p] = {};  // the last producer closes the channel
+        },
+        [&](int c) {
+            try {
+                for (;;) rxs[c].receive();
+            } catch (const std::future_error&) {  // closed and drained
+            }
+        });
+}
+
+double channel_batch(int producers, int consumers) {
+    auto [tx, rx] = Channel<int>::make(kCapacity);
+    std::vector<Channel<int>::Sender> txs(producers, tx);
+    std::vector<Channel<int>::Receiver> rxs(consumers, rx);
+    tx = {};
+    rx = {};
+    return run(
+        producers, consumers,
+        [&](int p) {
+            int buf[kBatch] = {};
+            for (int i = 0; i < kItems / producers; i += kBatch) txs[p].send_batch(buf, kBatch);
+            txs[p] = {};
+        },
+        [&](int c) {
+            int buf[kBatch];
+            while (rxs[c].receive_batch(buf, kBatch)) {
+            }
+        });
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-10s %14s %14s %14s\n", "P x C", "mutex+deque", "Channel", "Channel batch");
+    for (int n : {1, 2, 4}) {
+        std::printf("%d x %-6d %14.1f %14.1f %14.1f\n", n, n, mutex_deque(n, n), channel(n, n),
+                    channel_batch(n, n));
+    }
+    std::printf("(million items/s, capacity %zu, batch %zu)\n", kCapacity, kBatch);
+}
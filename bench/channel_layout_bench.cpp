@@ -0,0 +1,98 @@
+// OneShotChannel layout: Packed vs CacheAligned shared state.
+//
+// - bytes/channel: heap bytes requested by make() (alloc_counter)
+// - neighbours: one thread per channel, all channels made back to back so
+//   their states sit next to each other; each thread runs set/get/reset on
+//   its own channel. Prints ns per round.
+// - ping-pong: two threads hand a value back and forth over two channels.
+//   Prints ns per round trip.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "OneShotChannel.hpp"
+#include "alloc_counter.hpp"
+
+namespace {
+
+constexpr int kNeighbourRounds = 200000;
+constexpr int kPingPongRounds = 50000;
+
+template<typename Layout>
+using Channel = OneShotChannel<int, NullObserver, Layout>;
+
+template<typename Layout>
+std::uint64_t bytes_per_channel() {
+    auto before = alloc_counter::thread_counts().bytes;
+    auto ch = Channel<Layout>::make();
+    return alloc_counter::thread_counts().bytes - before;
+}
+
+template<typename Layout>
+double neighbours(int threads) {
+    std::vector<std::pair<typename Channel<Layout>::Sender, typename Channel<Layout>::Receiver>> channels;
+    for (int t = 0; t < threads; ++t) channels.push_back(Channel<Layout>::make());
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            auto& [s, r] = channels[t];
+            ready++;
+            while (!go.load()) std::this_thread::yield();
+            for (int i = 0; i < kNeighbourRounds; ++i) {
+                s.set_value(i);
+                r.get();
+                r.reset();
+            }
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& w : workers) w.join();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(ns.count()) / kNeighbourRounds;
+}
+
+template<typename Layout>
+double ping_pong() {
+    auto [ping_s, ping_r] = Channel<Layout>::make();
+    auto [pong_s, pong_r] = Channel<Layout>::make();
+
+    std::thread echo([&ping_r = ping_r, &pong_s = pong_s]() {
+        for (int i = 0; i < kPingPongRounds; ++i) {
+            int v = ping_r.get();
+            ping_r.reset();  // before answering, so the next ping finds a fresh generation
+            pong_s.set_value(v);
+        }
+    });
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kPingPongRounds; ++i) {
+        ping_s.set_value(i);
+        pong_r.get();
+        pong_r.reset();
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    echo.join();
+    return static_cast<double>(ns.count()) / kPingPongRounds;
+}
+
+} // namespace
+
+int main() {
+    using oneshot_layout::CacheAligned;
+    using oneshot_layout::Packed;
+    int threads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+    std::printf("%-28s %12s %12s\n", "case", "Packed", "CacheAligned");
+    std::printf("%-28s %12llu %12llu\n", "bytes/channel", (unsigned long long)bytes_per_channel<Packed>(),
+                (unsigned long long)bytes_per_channel<CacheAligned>());
+    std::printf("%-22s (%2d thr) %12.1f %12.1f\n", "neighbours ns/round", threads, neighbours<Packed>(threads),
+                neighbours<CacheAligned>(threads));
+    std::printf("%-28s %12.1f %12.1f\n", "ping-pong ns/round trip", ping_pong<Packed>(), ping_pong<CacheAligned>());
+}
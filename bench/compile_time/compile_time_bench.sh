@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+#
+# Compile-time and code-size benchmark for the one-shot headers.
+#
+# For each header, generates a translation unit that includes it and uses
+# OneShot / OneShotChannel with $TYPES distinct value types plus void, then
+# reports the mean compile time over $RUNS runs, the preprocessed size, and the
+# .text size of the object file.
+#
+#   bench/compile_time/compile_time_bench.sh                  # this tree
+#   BASELINE=/path/to/old/include bench/compile_time/compile_time_bench.sh
+#
+# With BASELINE set, the same TUs are also built against that include
+# directory (e.g. `git archive <rev> include | tar -x -C /tmp/old`) for a
+# before/after comparison.
+#
+set -euo pipefail
+
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O2}
+RUNS=${RUNS:-5}
+TYPES=${TYPES:-8}
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+gen_tu() {  # header class
+    local header=$1 cls=$2
+    echo "#include \"$header\""
+    for ((i = 0; i < TYPES; ++i)); do echo "struct V$i { int x; };"; done
+    echo "int use() {"
+    echo "    int sum = 0;"
+    for ((i = 0; i < TYPES; ++i)); do
+        cat <<CPP
+    {
+        auto [s, r] = $cls<V$i>::make();
+        s.set_value(V$i{$i});
+        auto v = r.get_for(std::chrono::milliseconds(1));
+        sum += v ? v->x : 0;
+    }
+CPP
+    done
+    cat <<CPP
+    {
+        auto [s, r] = $cls<void>::make();
+        s.set_value();
+        sum += r.get_for(std::chrono::milliseconds(1)) ? 1 : 0;
+    }
+    return sum;
+}
+CPP
+}
+
+measure() {  # label include_dir tu
+    local label=$1 inc=$2 tu=$3
+    local start end ms lines text
+    start=$(date +%s%N)
+    for ((n = 0; n < RUNS; ++n)); do
+        # shellcheck disable=SC2086
+        $CXX $CXXFLAGS -I"$inc" -c "$tu" -o "$WORK/tu.o"
+    done
+    end=$(date +%s%N)
+    ms=$(((end - start) / RUNS / 1000000))
+    # shellcheck disable=SC2086
+    lines=$($CXX $CXXFLAGS -I"$inc" -E "$tu" | wc -l)
+    text=$(size "$WORK/tu.o" | awk 'NR == 2 { print $1 }')
+    printf "%-36s %8d ms %10d lines %10d bytes .text\n" "$label" "$ms" "$lines" "$text"
+}
+
+echo "$CXX $CXXFLAGS, $RUNS runs, $TYPES value types + void"
+for spec in OneShotFuture.hpp:OneShot OneShotChannel.hpp:OneShotChannel; do
+    header=${spec%%:*}
+    cls=${spec##*:}
+    tu="$WORK/${cls}.cpp"
+    gen_tu "$header" "$cls" > "$tu"
+    if [[ -n "${BASELINE:-}" ]]; then measure "$header (baseline)" "$BASELINE" "$tu"; fi
+    measure "$header" "$ROOT/include" "$tu"
+done
@@ -0,0 +1,74 @@
+// Exchanger<int> vs. two OneShotChannels reset every round.
+//
+// Two threads swap a value kSwaps times, as a double-buffered pipeline swaps
+// its buffers each cycle. The channel version is the hand-rolled pattern
+// Exchanger replaces: each side sets its outgoing channel, waits until the
+// partner read it (set_value_and_wait), resets it, and reads the partner's.
+// Prints millions of swaps per second and the heap allocations per swap.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include "Exchanger.hpp"
+#include "OneShotChannel.hpp"
+#include "alloc_counter.hpp"
+
+namespace {
+
+constexpr int kSwaps = 1 << 18;
+
+struct Result {
+    double rate;         // million swaps per second
+    double allocations;  // per swap, both threads
+};
+
+template<typename Side>
+Result run(Side&& side) {
+    std::uint64_t allocs[2] = {};
+    auto start = std::chrono::steady_clock::now();
+    std::thread other([&] { allocs[1] = alloc_counter::count_allocations([&] { side(1); }); });
+    allocs[0] = alloc_counter::count_allocations([&] { side(0); });
+    other.join();
+    std::chrono::duration<double> s = std::chrono::steady_clock::now() - start;
+    return {kSwaps / s.count() / 1e6, double(allocs[0] + allocs[1]) / kSwaps};
+}
+
+Result two_channels() {
+    using Ch = OneShotChannel<int>;
+    auto ab = Ch::make();  // side 0 -> side 1
+    auto ba = Ch::make();  // side 1 -> side 0
+    return run([&](int side) {
+        if (side == 0) {
+            for (int i = 0; i < kSwaps; ++i) {
+                ab.first.set_value_and_wait(i);
+                ab.first.reset();
+                (void)ba.second.get();
+            }
+        } else {
+            for (int i = 0; i < kSwaps; ++i) {
+                (void)ab.second.get();
+                ba.first.set_value_and_wait(i);
+                ba.first.reset();
+            }
+        }
+    });
+}
+
+Result exchanger() {
+    Exchanger<int> ex;
+    return run([&](int side) {
+        int v = side;
+        for (int i = 0; i < kSwaps; ++i) v = ex.exchange(v);
+    });
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-22s %12s %14s\n", "", "Mswaps/s", "allocs/swap");
+    Result c = two_channels();
+    std::printf("%-22s %12.2f %14.2f\n", "2 x OneShotChannel", c.rate, c.allocations);
+    Result e = exchanger();
+    std::printf("%-22s %12.2f %14.2f\n", "Exchanger", e.rate, e.allocations);
+    std::printf("(%d swaps between two threads, %u hardware threads)\n", kSwaps, std::thread::hardware_concurrency());
+}
@@ -0,0 +1,283 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <optional>
+#include <exception>
+#include <chrono>
+#include <mutex>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <type_traits>
+
+#include "OneShotFuture.hpp"
+
+namespace async_cache_detail {
+
+//
+// Stamps each entry's OneShot state with when it completed and whether its
+// sender was dropped, for the TTL and broken-promise checks. Hooks run before
+// the state is published, so a reader that saw it ready sees the stamp.
+//
+struct EntryObserver {
+    struct Data {
+        std::atomic<std::chrono::steady_clock::rep> ready_at{0};
+        std::atomic<bool> broken{false};
+    };
+
+    static std::uint64_t now() noexcept { return 0; }
+    static void on_create(Data&) noexcept {}
+    static void on_set(Data& d) noexcept { stamp(d); }
+    static void on_broken(Data& d) noexcept {
+        d.broken.store(true, std::memory_order_relaxed);
+        stamp(d);
+    }
+    static void on_wait(Data&) noexcept {}
+    static void on_wake(Data&, std::uint64_t) noexcept {}
+    static void on_timeout(Data&, std::uint64_t) noexcept {}
+    static void on_consume(Data&) noexcept {}
+    static void on_reset(Data&) noexcept {}
+
+private:
+    static void stamp(Data& d) noexcept {
+        d.ready_at.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+};
+
+} // namespace async_cache_detail
+
+//
+// A sharded LRU/TTL cache whose entries are one-shot results.
+//
+// Every entry is a single OneShot shared state that is either still loading or
+// ready (with a value or an exception). A lookup therefore answers "cached, in
+// flight, or start it" in one step:
+//   - ready or in flight: you get a Receiver on the existing state
+//   - missing or expired: you get a Receiver *and* the Sender; you own the load
+//
+// Exceptions delivered via Sender::set_exception are cached negatively for
+// Options::negative_ttl. A Sender dropped without a result (broken promise) is
+// never cached: the next lookup starts a fresh load.
+//
+// Entries still loading are never evicted, since the next lookup would start
+// a second load for the same key; a shard may exceed its capacity until they
+// complete.
+//
+// Thread safety: lookups lock only the shard owning the key.
+template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class AsyncCache {
+    static_assert(!std::is_void<V>::value, "AsyncCache<K, void> is not supported; cache a value such as bool");
+
+    using Shot = OneShot<V, async_cache_detail::EntryObserver>;
+    using State = typename std::decay_t<decltype(oneshot_detail::Access::state(
+        std::declval<typename Shot::Receiver&>()))>::element_type;
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::size_t capacity = 1024;                  // total entries, split evenly across shards; see above
+        std::size_t shards = 16;
+        Clock::duration ttl = Clock::duration::max(); // lifetime of a value, counted from completion
+        Clock::duration negative_ttl = std::chrono::seconds(1); // lifetime of a cached exception
+    };
+
+    //
+    // Fulfils one cache entry. Same contract as OneShot<V>::Sender.
+    //
+    class Sender {
+        typename Shot::Sender sender_;
+
+    public:
+        Sender() = default;
+        explicit Sender(typename Shot::Sender s) : sender_(std::move(s)) {}
+
+        bool set_value(V value) { return sender_.set_value(std::move(value)); }
+        bool set_exception(std::exception_ptr e) { return sender_.set_exception(std::move(e)); }
+
+        explicit operator bool() const noexcept { return (bool)sender_; }
+    };
+
+    //
+    // Observes one cache entry. Any number of receivers may share an entry, so get()
+    // can be called repeatedly and returns a reference owned by the receiver.
+    //
+    class Receiver {
+        std::shared_ptr<State> state_;
+
+    public:
+        Receiver() = default;
+        explicit Receiver(std::shared_ptr<State> s) : state_(std::move(s)) {}
+
+        // Unlike OneShot<V>::Receiver::get(), leaves the result in place.
+        const V& get() const {
+            if (!state_) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+            state_->wait();
+            if (state_->error) std::rethrow_exception(state_->error);
+            return *state_->value;
+        }
+
+        bool ready() const { return state_ && state_->is_ready(); }
+
+        template<typename Rep, typename Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& dur) const {
+            if (!state_) return false;
+            return state_->wait_until(Clock::now() + std::chrono::duration_cast<Clock::duration>(dur));
+        }
+
+        // Returns std::optional<V> with timeout
+        template<typename Rep, typename Period>
+        std::optional<V> get_for(const std::chrono::duration<Rep, Period>& dur) const {
+            if (wait_for(dur)) return get();
+            return std::nullopt;
+        }
+
+        explicit operator bool() const noexcept { return (bool)state_; }
+    };
+
+    //
+    // Result of acquire(). `sender` is valid only when the caller must start the load.
+    //
+    struct Lookup {
+        Receiver receiver;
+        Sender sender;
+    };
+
+    explicit AsyncCache(Options opts = {}, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual())
+        : opts_(opts), hash_(hash) {
+        std::size_t n = opts.shards ? opts.shards : 1;
+        for (std::size_t i = 0; i < n; ++i) shards_.emplace_back(hash, eq);
+        per_shard_capacity_ = (opts_.capacity + n - 1) / n;
+        if (per_shard_capacity_ == 0) per_shard_capacity_ = 1;
+    }
+
+    AsyncCache(const AsyncCache&) = delete;
+    AsyncCache& operator=(const AsyncCache&) = delete;
+
+    // Returns the ready or in-flight entry for `key`, or installs a new pending
+    // entry and hands its Sender to the caller.
+    Lookup acquire(const K& key) {
+        Shard& shard = shard_for(key);
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            auto node = it->second;
+            if (fresh(*node->state, now)) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, node);
+                return {Receiver{node->state}, Sender{}};
+            }
+            shard.lru.erase(node);
+            shard.index.erase(it);
+        }
+        auto [s, r] = Shot::make();
+        // the cache's receivers read the state without consuming it
+        std::shared_ptr<State> state = std::move(oneshot_detail::Access::state(r));
+        shard.lru.push_front(Entry{key, state});
+        shard.index.emplace(key, shard.lru.begin());
+        evict_locked(shard);
+        return {Receiver{std::move(state)}, Sender{std::move(s)}};
+    }
+
+    // Returns the ready or in-flight entry for `key` without ever starting a load.
+    std::optional<Receiver> find(const K& key) {
+        Shard& shard = shard_for(key);
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return std::nullopt;
+        auto node = it->second;
+        if (!fresh(*node->state, now)) {
+            shard.lru.erase(node);
+            shard.index.erase(it);
+            return std::nullopt;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, node);
+        return Receiver{node->state};
+    }
+
+    // acquire() followed by `loader(Sender)` on a miss. The loader runs on the
+    // calling thread outside any cache lock and may hand the Sender elsewhere.
+    template<typename F>
+    Receiver get_or_load(const K& key, F&& loader) {
+        Lookup l = acquire(key);
+        if (l.sender) std::forward<F>(loader)(std::move(l.sender));
+        return std::move(l.receiver);
+    }
+
+    bool erase(const K& key) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) return false;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        return true;
+    }
+
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            shard.index.clear();
+            shard.lru.clear();
+        }
+    }
+
+    std::size_t size() const {
+        std::size_t n = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            n += shard.lru.size();
+        }
+        return n;
+    }
+
+private:
+    struct Entry {
+        K key;
+        std::shared_ptr<State> state;
+    };
+
+    struct Shard {
+        mutable std::mutex mtx;
+        std::list<Entry> lru;  // most recently used first
+        std::unordered_map<K, typename std::list<Entry>::iterator, Hash, KeyEqual> index;
+
+        Shard(const Hash& hash, const KeyEqual& eq) : index(0, hash, eq) {}
+    };
+
+    Options opts_;
+    Hash hash_;
+    std::deque<Shard> shards_;  // constructed in place: a Shard cannot move
+    std::size_t per_shard_capacity_ = 1;
+
+    Shard& shard_for(const K& key) { return shards_[hash_(key) % shards_.size()]; }
+
+    static bool in_flight(const State& state) { return !state.is_ready(); }
+
+    bool fresh(const State& state, Clock::time_point now) const {
+        if (in_flight(state)) return true;
+        if (state.broken.load(std::memory_order_relaxed)) return false;
+        Clock::time_point ready_at{Clock::duration{state.ready_at.load(std::memory_order_relaxed)}};
+        Clock::duration limit = state.error ? opts_.negative_ttl : opts_.ttl;
+        return now - ready_at < limit;
+    }
+
+    // Drops least recently used entries down to capacity, skipping loads in flight.
+    void evict_locked(Shard& shard) {
+        auto it = shard.lru.end();
+        while (shard.lru.size() > per_shard_capacity_ && it != shard.lru.begin()) {
+            --it;
+            if (in_flight(*it->state)) continue;
+            shard.index.erase(it->key);
+            it = shard.lru.erase(it);
+        }
+    }
+};
@@ -0,0 +1,411 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "OneShotValue.hpp"
+#include "OneShotWait.hpp"
+
+//
+// Bounded multi-producer multi-consumer channel with the ergonomics of the
+// one-shots: Sender and Receiver halves, and closing that mirrors a broken
+// promise.
+//
+//   auto [tx, rx] = Channel<Job>::make(1024);
+//   tx.send(job);                       // blocks while full
+//   Job j = rx.receive();               // blocks while empty
+//   auto maybe = rx.receive_for(10ms);  // std::optional<Job>
+//
+// The buffer is a Vyukov ring: every slot carries a sequence number telling
+// producers and consumers whose turn it is, so an uncontended send or receive
+// is one CAS plus one store, without a lock. Threads sleep on a
+// oneshot_detail::WaitQueue only when the channel is full (senders) or empty
+// (receivers); waking costs nothing while nobody sleeps. Fibers park instead
+// of blocking, and blocking waits on non-blocking threads are reported (see
+// OneShotBlocking.hpp).
+//
+// Handles can be copied; the channel is closed when the last Sender is
+// dropped or any Sender calls close(). Sends then fail, and receivers drain
+// what was sent, including sends that were already under way, after which receive() throws broken_promise and receive_for()
+// returns empty. Once the last Receiver is dropped, sends fail as well.
+//
+// The capacity is rounded up to a power of two (at least 2); make() throws
+// std::length_error when no such power fits in size_t. T must be nothrow move
+// constructible, since a claimed slot cannot be given back.
+//
+template<typename T>
+class Channel {
+    static_assert(!std::is_void<T>::value, "Channel<void> is not supported; use a counter or OneShotChannel<void>");
+    static_assert(std::is_nothrow_move_constructible<T>::value, "Channel<T> requires nothrow move construction");
+
+    struct Slot {
+        std::atomic<std::size_t> seq{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* ptr() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    struct State {
+        // producers and consumers each own a line
+        alignas(oneshot_layout::cache_line) std::atomic<std::size_t> enqueue_pos{0};
+        alignas(oneshot_layout::cache_line) std::atomic<std::size_t> dequeue_pos{0};
+        alignas(oneshot_layout::cache_line) std::atomic<std::size_t> senders{1};
+        std::atomic<std::size_t> receivers{1};
+        std::atomic<bool> closed{false};
+        std::atomic<std::size_t> pushing{0};  // sends between their closed check and their push
+        std::size_t mask;
+        std::unique_ptr<Slot[]> slots;
+        oneshot_detail::WaitQueue not_empty;  // receivers sleep here
+        oneshot_detail::WaitQueue not_full;   // senders sleep here
+
+        explicit State(std::size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {
+            for (std::size_t i = 0; i < capacity; ++i) slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+        State(const State&) = delete;
+        State& operator=(const State&) = delete;
+
+        ~State() {
+            // no handles left: whatever was sent and not received is destroyed here
+            std::size_t end = enqueue_pos.load(std::memory_order_relaxed);
+            for (std::size_t pos = dequeue_pos.load(std::memory_order_relaxed); pos != end; ++pos) {
+                Slot& s = slots[pos & mask];
+                if (s.seq.load(std::memory_order_relaxed) == pos + 1) s.ptr()->~T();
+            }
+        }
+
+        // Claims the next free slot and moves `v` into it; false if full.
+        bool try_push(T& v) noexcept {
+            std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& s = slots[pos & mask];
+                std::size_t seq = s.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        ::new (static_cast<void*>(s.storage)) T(std::move(v));
+                        s.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Claims the oldest full slot and moves its value out; empty if none.
+        std::optional<T> try_pop() noexcept {
+            std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& s = slots[pos & mask];
+                std::size_t seq = s.seq.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        std::optional<T> v(std::move(*s.ptr()));
+                        s.ptr()->~T();
+                        s.seq.store(pos + mask + 1, std::memory_order_release);
+                        return v;
+                    }
+                } else if (diff < 0) {
+                    return std::nullopt;
+                } else {
+                    pos = dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool has_item() const noexcept {
+            std::size_t pos = dequeue_pos.load(std::memory_order_acquire);
+            return slots[pos & mask].seq.load(std::memory_order_acquire) == pos + 1;
+        }
+
+        bool has_space() const noexcept {
+            std::size_t pos = enqueue_pos.load(std::memory_order_acquire);
+            return slots[pos & mask].seq.load(std::memory_order_acquire) == pos;
+        }
+
+        bool receivers_gone() const noexcept { return receivers.load(std::memory_order_acquire) == 0; }
+        bool is_closed() const noexcept { return closed.load(std::memory_order_acquire); }
+        bool can_send() const noexcept { return !is_closed() && !receivers_gone(); }
+
+        // Closed, and no send that passed its check before close() is still
+        // pushing: an empty ring is then final.
+        bool drained_closed() const noexcept {
+            return is_closed() && pushing.load(std::memory_order_seq_cst) == 0;
+        }
+
+        // Brackets a push. Announcing it before checking `closed` (both seq_cst,
+        // against close()) means a receiver that sees the channel closed with
+        // nothing pushing cannot miss a value that is still on its way.
+        bool begin_push() {
+            pushing.fetch_add(1, std::memory_order_seq_cst);
+            if (!closed.load(std::memory_order_seq_cst) && !receivers_gone()) return true;
+            end_push();
+            return false;
+        }
+
+        void end_push() {
+            if (pushing.fetch_sub(1, std::memory_order_acq_rel) == 1 && is_closed()) not_empty.notify_all();
+        }
+
+        // try_push, unless the channel is closed or has no receivers.
+        bool try_send(T& v) {
+            if (!begin_push()) return false;
+            bool pushed = try_push(v);
+            end_push();
+            if (pushed) not_empty.notify();
+            return pushed;
+        }
+
+        void close() {
+            if (closed.exchange(true, std::memory_order_seq_cst)) return;
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+
+        void drop_receiver() {
+            if (receivers.fetch_sub(1, std::memory_order_acq_rel) == 1) not_full.notify_all();
+        }
+
+        // Sleeps while full; false once closed, once every receiver is gone, or at `deadline`.
+        bool push(T& v, const std::chrono::steady_clock::time_point* deadline) {
+            for (;;) {
+                if (!can_send()) return false;
+                if (try_send(v)) return true;
+                if (deadline && std::chrono::steady_clock::now() >= *deadline) return false;
+                not_full.wait([this] { return has_space() || !can_send(); }, deadline);
+            }
+        }
+
+        // Sleeps while empty; empty once closed and drained or at `deadline`.
+        std::optional<T> pop(const std::chrono::steady_clock::time_point* deadline) {
+            for (;;) {
+                if (auto v = try_pop()) {
+                    not_full.notify();
+                    return v;
+                }
+                if (drained_closed()) {
+                    // values sent before close() may have landed after the first attempt
+                    auto v = try_pop();
+                    if (v) not_full.notify();
+                    return v;
+                }
+                if (deadline && std::chrono::steady_clock::now() >= *deadline) return std::nullopt;
+                not_empty.wait([this] { return has_item() || drained_closed(); }, deadline);
+            }
+        }
+    };
+
+    static std::chrono::steady_clock::time_point deadline_after(std::chrono::steady_clock::duration d) {
+        return std::chrono::steady_clock::now() + d;
+    }
+
+public:
+    class Sender {
+        friend struct oneshot_detail::Access;
+        std::shared_ptr<State> state_;
+
+    public:
+        using value_type = T;
+
+        Sender() = default;
+        explicit Sender(std::shared_ptr<State> s) : state_(std::move(s)) {}
+
+        // Copies are further senders of the same channel.
+        Sender(const Sender& other) : state_(other.state_) {
+            if (state_) state_->senders.fetch_add(1, std::memory_order_relaxed);
+        }
+        Sender& operator=(const Sender& other) {
+            if (this != &other) *this = Sender(other);
+            return *this;
+        }
+        Sender(Sender&&) noexcept = default;
+        Sender& operator=(Sender&& other) noexcept {
+            if (this != &other) {
+                release();
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
+
+        // The last sender closes the channel, like a dropped promise.
+        ~Sender() { release(); }
+
+        // Blocks while full. False once the channel is closed or every receiver
+        // is gone.
+        bool send(T value) { return state_ && state_->push(value, nullptr); }
+
+        // Moves from `value` only on success; false if full, closed or without receivers.
+        bool try_send(T&& value) {
+            return state_ && state_->try_send(value);
+        }
+
+        // Like send(), giving up after `timeout`; moves from `value` only on success.
+        template<typename Rep, typename Period>
+        bool send_for(T&& value, const std::chrono::duration<Rep, Period>& timeout) {
+            if (try_send(std::move(value))) return true;  // no clock read when there is room
+            if (!state_) return false;
+            auto deadline = deadline_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+            return state_->push(value, &deadline);
+        }
+
+        // Moves values[0, n) into the channel without blocking, for the largest
+        // n that fits, waking up to n receivers at once. Returns n.
+        std::size_t try_send_batch(T* values, std::size_t count) {
+            if (!state_ || !state_->begin_push()) return 0;
+            std::size_t n = 0;
+            while (n < count && state_->try_push(values[n])) ++n;
+            state_->end_push();
+            if (n) state_->not_empty.notify(n);
+            return n;
+        }
+
+        // Sends all of values[0, count), blocking while full. Returns how many
+        // were sent, fewer only if the channel was closed or lost its receivers.
+        std::size_t send_batch(T* values, std::size_t count) {
+            std::size_t sent = 0;
+            while (sent < count) {
+                sent += try_send_batch(values + sent, count - sent);
+                if (sent == count || !state_ || !state_->push(values[sent], nullptr)) break;
+                ++sent;
+            }
+            return sent;
+        }
+
+        // Closes the channel for all senders; receivers drain what was sent and
+        // further sends fail.
+        void close() {
+            if (state_) state_->close();
+        }
+
+        // True once the channel is closed or every receiver is gone.
+        bool closed() const noexcept { return !state_ || !state_->can_send(); }
+
+        std::size_t capacity() const noexcept { return state_ ? state_->mask + 1 : 0; }
+
+        explicit operator bool() const noexcept { return (bool)state_; }
+
+    private:
+        void release() {
+            if (state_ && state_->senders.fetch_sub(1, std::memory_order_acq_rel) == 1) state_->close();
+            state_.reset();
+        }
+    };
+
+    class Receiver {
+        friend struct oneshot_detail::Access;
+        std::shared_ptr<State> state_;
+
+    public:
+        using value_type = T;
+
+        Receiver() = default;
+        explicit Receiver(std::shared_ptr<State> s) : state_(std::move(s)) {}
+
+        // Copies are further receivers of the same channel; each value goes to one.
+        Receiver(const Receiver& other) : state_(other.state_) {
+            if (state_) state_->receivers.fetch_add(1, std::memory_order_relaxed);
+        }
+        Receiver& operator=(const Receiver& other) {
+            if (this != &other) *this = Receiver(other);
+            return *this;
+        }
+        Receiver(Receiver&&) noexcept = default;
+        Receiver& operator=(Receiver&& other) noexcept {
+            if (this != &other) {
+                release();
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
+
+        ~Receiver() { release(); }
+
+        // Blocks while empty. Throws broken_promise once the channel is closed
+        // and drained, like get() on a OneShot whose sender was dropped.
+        T receive() {
+            if (!state_) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+            if (auto v = state_->pop(nullptr)) return std::move(*v);
+            std::rethrow_exception(oneshot_detail::broken_promise());
+        }
+
+        std::optional<T> try_receive() {
+            if (!state_) return std::nullopt;
+            auto v = state_->try_pop();
+            if (v) state_->not_full.notify();
+            return v;
+        }
+
+        // Empty on timeout, or once the channel is closed and drained.
+        template<typename Rep, typename Period>
+        std::optional<T> receive_for(const std::chrono::duration<Rep, Period>& timeout) {
+            if (auto v = try_receive()) return v;  // no clock read when a value is there
+            if (!state_) return std::nullopt;
+            auto deadline = deadline_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+            return state_->pop(&deadline);
+        }
+
+        // Moves up to `max` values into out[0, n) without blocking, waking up
+        // to n senders at once. Returns n.
+        std::size_t try_receive_batch(T* out, std::size_t max) {
+            static_assert(std::is_move_assignable<T>::value, "receiving into an array requires move-assignable T");
+            if (!state_) return 0;
+            std::size_t n = 0;
+            for (; n < max; ++n) {
+                auto v = state_->try_pop();
+                if (!v) break;
+                out[n] = std::move(*v);
+            }
+            if (n) state_->not_full.notify(n);
+            return n;
+        }
+
+        // Blocks until at least one value is available, then takes up to `max`.
+        // Returns 0 only once the channel is closed and drained.
+        std::size_t receive_batch(T* out, std::size_t max) {
+            if (!state_ || max == 0) return 0;
+            std::size_t n = try_receive_batch(out, max);
+            if (n) return n;
+            auto first = state_->pop(nullptr);
+            if (!first) return 0;
+            out[0] = std::move(*first);
+            return 1 + try_receive_batch(out + 1, max - 1);
+        }
+
+        // True once the channel is closed and drained.
+        bool closed() const noexcept { return !state_ || (state_->drained_closed() && !state_->has_item()); }
+
+        std::size_t capacity() const noexcept { return state_ ? state_->mask + 1 : 0; }
+
+        explicit operator bool() const noexcept { return (bool)state_; }
+
+    private:
+        void release() {
+            if (state_) state_->drop_receiver();
+            state_.reset();
+        }
+    };
+
+    static std::pair<Sender, Receiver> make(std::size_t capacity) {
+        constexpr std::size_t max_cap = (SIZE_MAX >> 1) + 1;  // largest power of two
+        if (capacity > max_cap) throw std::length_error("Channel: capacity too large");
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        auto state = std::make_shared<State>(cap);
+        return {Sender{state}, Receiver{std::move(state)}};
+    }
+};
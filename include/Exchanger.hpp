@@ -0,0 +1,154 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "OneShotWait.hpp"
+
+//
+// Two-party rendezvous that swaps values: each side calls exchange(v) and gets
+// the other side's value once both have arrived.
+//
+//   Exchanger<Buffer> swap;
+//   // filler thread                         // drainer thread
+//   Buffer b = ...;                          Buffer b = ...;
+//   for (;;) {                               for (;;) {
+//       fill(b);                                 b = swap.exchange(std::move(b));
+//       b = swap.exchange(std::move(b));         drain(b);
+//   }                                        }
+//
+// The first to arrive offers its value and waits; the second takes it, leaves
+// its own and returns at once. A third caller waits for the next round, so any
+// number of threads may share one Exchanger; they are paired two at a time.
+//
+// The round state and both values share one cache line; nothing is allocated
+// and no lock is taken while the partner is already there. Waiters spin
+// briefly (not on single-CPU machines), then sleep on a WaitQueue kept on its
+// own line, or park the current fiber under a scheduler (OneShotFiber.hpp).
+//
+template<typename T>
+class Exchanger {
+    static_assert(!std::is_void<T>::value, "Exchanger<void> has nothing to swap; use a barrier");
+    static_assert(std::is_nothrow_move_constructible<T>::value, "Exchanger<T> requires nothrow move construction");
+
+    // Empty -> Offering -> Offered -> Taking -> Answered -> Empty; Offered -> Empty on timeout
+    enum : std::uint32_t { Empty, Offering, Offered, Taking, Answered };
+
+    struct alignas(oneshot_layout::cache_line) Round {
+        std::atomic<std::uint32_t> state{Empty};
+        std::optional<T> offered;   // written by the first side
+        std::optional<T> answered;  // written by the second side
+    };
+
+    Round round_;
+    alignas(oneshot_layout::cache_line) oneshot_detail::WaitQueue waiters_;
+
+public:
+    Exchanger() = default;
+    Exchanger(const Exchanger&) = delete;
+    Exchanger& operator=(const Exchanger&) = delete;
+
+    // Returns the partner's value once one has arrived.
+    T exchange(T value) {
+        exchange_until(value, nullptr);
+        return value;
+    }
+
+    // Swaps `value` with the partner's; false (and `value` untouched) if no
+    // partner arrived within `timeout`.
+    template<typename Rep, typename Period>
+    bool exchange_for(T& value, const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+        return exchange_until(value, &deadline);
+    }
+
+private:
+    bool exchange_until(T& value, const std::chrono::steady_clock::time_point* deadline) {
+        for (;;) {
+            std::uint32_t s = round_.state.load(std::memory_order_acquire);
+            if (s == Empty && advance(s, Offering)) return offer(value, deadline);
+            if (s == Offered && advance(s, Taking)) {
+                T theirs = std::move(*round_.offered);
+                round_.offered.reset();
+                round_.answered.emplace(std::move(value));
+                publish(Answered);
+                value = std::move(theirs);
+                return true;
+            }
+            // Offering, or a round in progress: wait until one can be joined
+            if (!await([this] {
+                    std::uint32_t now = round_.state.load(std::memory_order_acquire);
+                    return now == Empty || now == Offered;
+                }, deadline)) {
+                return false;
+            }
+        }
+    }
+
+    bool offer(T& value, const std::chrono::steady_clock::time_point* deadline) {
+        round_.offered.emplace(std::move(value));
+        publish(Offered);
+        auto answered = [this] { return round_.state.load(std::memory_order_acquire) == Answered; };
+        if (!await(answered, deadline)) {
+            std::uint32_t s = Offered;
+            if (advance(s, Empty)) {  // withdrawn before a partner took it
+                value = std::move(*round_.offered);
+                round_.offered.reset();
+                waiters_.notify_all();
+                return false;
+            }
+            await(answered, nullptr);  // taken meanwhile: the answer is on its way
+        }
+        value = std::move(*round_.answered);
+        round_.answered.reset();
+        publish(Empty);
+        return true;
+    }
+
+    bool advance(std::uint32_t& expected, std::uint32_t next) noexcept {
+        return round_.state.compare_exchange_strong(expected, next, std::memory_order_acq_rel,
+                                                    std::memory_order_relaxed);
+    }
+
+    void publish(std::uint32_t next) {
+        round_.state.store(next, std::memory_order_release);
+        waiters_.notify_all();  // a fence and a load while nobody sleeps
+    }
+
+    template<typename Ready>
+    bool await(Ready&& ready, const std::chrono::steady_clock::time_point* deadline) {
+        // a fiber's partner runs on the same carrier: spinning cannot help
+        for (int i = oneshot_detail::current_parker() ? 0 : spin_limit(); i > 0; --i) {
+            if (ready()) return true;
+            cpu_relax();
+        }
+        while (!ready()) {
+            if (deadline && std::chrono::steady_clock::now() >= *deadline) return false;
+            waiters_.wait(ready, deadline);
+        }
+        return true;
+    }
+
+    static int spin_limit() noexcept {
+        static const int limit = std::thread::hardware_concurrency() > 1 ? 256 : 0;
+        return limit;
+    }
+
+    static void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+    }
+};
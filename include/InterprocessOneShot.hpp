@@ -0,0 +1,368 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <optional>
+#include <chrono>
+#include <system_error>
+#include <type_traits>
+#include <new>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <cerrno>
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "OneShotError.hpp"
+
+//
+// Interprocess one-shot (Linux only).
+//
+// The whole state lives in a memfd mapping, so Sender and Receiver can be
+// attached from different processes: inherit the object across fork(), or pass
+// fd() to another process (SCM_RIGHTS, /proc/<pid>/fd) and attach(fd) there.
+// A shm_open() descriptor works with attach() as well.
+//
+// Waiting uses process-shared futexes only:
+//   - before a Sender attaches, the Receiver futex-waits on the state word
+//   - once attached, the Sender holds a robust process-shared mutex until it
+//     completes; the Receiver blocks on that mutex. If the sending thread or
+//     process dies first, the kernel's robust-futex cleanup hands the mutex to
+//     the Receiver with EOWNERDEAD, which is reported as broken_promise.
+//
+// The payload is copied in place into the mapping, so T must be trivially
+// copyable. Errors cross the process boundary as an errno-style code and are
+// rethrown as std::system_error.
+//
+// A Sender is bound to the thread that attached it (the robust mutex is owned
+// by that thread); complete or destroy it there. It can be moved within that
+// thread, but completing or destroying it on another one aborts with a message
+// instead of failing to unlock the mutex.
+template<typename T>
+class InterprocessOneShot {
+    static_assert(std::is_trivially_copyable<T>::value, "InterprocessOneShot<T> requires trivially copyable T");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "futex word must be lock-free");
+
+    enum State : std::uint32_t { Empty, Armed, Writing, Ready, Error, Broken };
+
+    struct Shared {
+        std::atomic<std::uint32_t> state{Empty};
+        pthread_mutex_t liveness;  // held by the attached Sender
+        std::int32_t error = 0;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Region {
+        int fd = -1;
+        Shared* shm = nullptr;
+
+        Region(int f, Shared* s) : fd(f), shm(s) {}
+        Region(const Region&) = delete;
+        Region& operator=(const Region&) = delete;
+        ~Region() {
+            if (shm) ::munmap(shm, sizeof(Shared));
+            if (fd >= 0) ::close(fd);
+        }
+    };
+
+    std::shared_ptr<Region> region_;
+
+    explicit InterprocessOneShot(std::shared_ptr<Region> r) : region_(std::move(r)) {}
+
+    static void throw_errno(const char* what) { throw std::system_error(errno, std::generic_category(), what); }
+
+    static Shared* map(int fd) {
+        void* addr = ::mmap(nullptr, sizeof(Shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            errno = err;
+            throw_errno("mmap");
+        }
+        return static_cast<Shared*>(addr);
+    }
+
+    static void futex_wake(std::atomic<std::uint32_t>& word) {
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    static void futex_wait(std::atomic<std::uint32_t>& word, std::uint32_t expected, const timespec* rel) {
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, rel, nullptr, 0);
+    }
+
+    static timespec to_timespec(std::chrono::nanoseconds ns) {
+        if (ns.count() < 0) ns = std::chrono::nanoseconds::zero();
+        timespec ts;
+        ts.tv_sec = static_cast<time_t>(ns.count() / 1000000000);
+        ts.tv_nsec = static_cast<long>(ns.count() % 1000000000);
+        return ts;
+    }
+
+    static int lock_until(pthread_mutex_t* m, const std::chrono::steady_clock::time_point* deadline) {
+        if (!deadline) return ::pthread_mutex_lock(m);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+        timespec abs = to_timespec(deadline->time_since_epoch());
+        return ::pthread_mutex_clocklock(m, CLOCK_MONOTONIC, &abs);
+#else
+        timespec now;
+        ::clock_gettime(CLOCK_REALTIME, &now);
+        auto abs_ns = std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec) +
+                      (*deadline - std::chrono::steady_clock::now());
+        timespec abs = to_timespec(abs_ns);
+        return ::pthread_mutex_timedlock(m, &abs);
+#endif
+    }
+
+public:
+    //
+    // Sending side
+    //
+    class Sender {
+        std::shared_ptr<Region> region_;
+        bool locked_ = false;
+        pthread_t owner_{};  // the attaching thread, which owns `liveness`
+
+        void check_thread() const noexcept {
+            if (locked_ && !::pthread_equal(owner_, ::pthread_self())) wrong_thread();
+        }
+
+        ONESHOT_NOINLINE static void wrong_thread() noexcept {
+            std::fprintf(stderr, "oneshot: InterprocessOneShot::Sender used from a thread other than the one that "
+                                 "attached it\n");
+            std::fflush(stderr);
+            std::abort();
+        }
+
+        void finish(std::uint32_t terminal) {
+            Shared* s = region_->shm;
+            s->state.store(terminal, std::memory_order_release);
+            futex_wake(s->state);
+            release();
+        }
+
+        void release() noexcept {
+            if (locked_) {
+                ::pthread_mutex_unlock(&region_->shm->liveness);
+                locked_ = false;
+            }
+        }
+
+        bool claim() {
+            if (!region_) return false;
+            check_thread();
+            std::uint32_t expected = Armed;
+            return region_->shm->state.compare_exchange_strong(expected, Writing, std::memory_order_acquire);
+        }
+
+    public:
+        Sender() = default;
+        explicit Sender(std::shared_ptr<Region> r) : region_(std::move(r)), locked_(true), owner_(::pthread_self()) {}
+
+        Sender(Sender&& other) noexcept
+            : region_(std::move(other.region_)), locked_(std::exchange(other.locked_, false)), owner_(other.owner_) {}
+        Sender& operator=(Sender&& other) noexcept {
+            if (this != &other) {
+                abandon();
+                region_ = std::move(other.region_);
+                locked_ = std::exchange(other.locked_, false);
+                owner_ = other.owner_;
+            }
+            return *this;
+        }
+        Sender(const Sender&) = delete;
+        Sender& operator=(const Sender&) = delete;
+
+        ~Sender() { abandon(); }
+
+        bool set_value(const T& value) {
+            if (!claim()) return false;
+            std::memcpy(region_->shm->storage, &value, sizeof(T));
+            finish(Ready);
+            return true;
+        }
+
+        // `code` is rethrown in the receiving process as std::system_error(code, generic_category())
+        bool set_error(int code) {
+            if (!claim()) return false;
+            region_->shm->error = code;
+            finish(Error);
+            return true;
+        }
+
+        explicit operator bool() const noexcept { return (bool)region_; }
+
+    private:
+        void abandon() noexcept {
+            if (claim()) {
+                finish(Broken);
+            } else if (region_) {
+                check_thread();
+                release();
+            }
+        }
+    };
+
+    //
+    // Receiving side
+    //
+    class Receiver {
+        std::shared_ptr<Region> region_;
+
+        // Returns true once the state is terminal, false on timeout.
+        bool wait(const std::chrono::steady_clock::time_point* deadline) const {
+            Shared* s = region_->shm;
+            for (;;) {
+                std::uint32_t st = s->state.load(std::memory_order_acquire);
+                if (st >= Ready) return true;
+                if (st == Empty) {
+                    // no Sender attached yet: wait for the state word to change
+                    if (deadline) {
+                        auto left = *deadline - std::chrono::steady_clock::now();
+                        if (left <= std::chrono::steady_clock::duration::zero()) return false;
+                        timespec rel = to_timespec(left);
+                        futex_wait(s->state, Empty, &rel);
+                    } else {
+                        futex_wait(s->state, Empty, nullptr);
+                    }
+                    continue;
+                }
+                // Armed/Writing: the Sender holds `liveness` until it completes or dies
+                int rc = lock_until(&s->liveness, deadline);
+                if (rc == ETIMEDOUT) return false;
+                if (rc == EOWNERDEAD) {
+                    std::uint32_t expected = Armed;
+                    if (!s->state.compare_exchange_strong(expected, Broken, std::memory_order_acq_rel)) {
+                        // died mid-write: the payload cannot be trusted
+                        expected = Writing;
+                        s->state.compare_exchange_strong(expected, Broken, std::memory_order_acq_rel);
+                    }
+                    ::pthread_mutex_consistent(&s->liveness);
+                    futex_wake(s->state);
+                } else if (rc != 0) {
+                    throw std::system_error(rc, std::generic_category(), "pthread_mutex_lock");
+                }
+                ::pthread_mutex_unlock(&s->liveness);
+            }
+        }
+
+        T take() const {
+            Shared* s = region_->shm;
+            switch (s->state.load(std::memory_order_acquire)) {
+            case Ready: {
+                T value;
+                std::memcpy(&value, s->storage, sizeof(T));
+                return value;
+            }
+            case Error:
+                throw std::system_error(s->error, std::generic_category());
+            default:
+                oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::BrokenPromise);
+            }
+        }
+
+    public:
+        Receiver() = default;
+        explicit Receiver(std::shared_ptr<Region> r) : region_(std::move(r)) {}
+
+        Receiver(Receiver&&) noexcept = default;
+        Receiver& operator=(Receiver&&) noexcept = default;
+        Receiver(const Receiver&) = delete;
+        Receiver& operator=(const Receiver&) = delete;
+
+        T get() {
+            if (!region_) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+            wait(nullptr);
+            return take();
+        }
+
+        bool ready() const {
+            return region_ && region_->shm->state.load(std::memory_order_acquire) >= Ready;
+        }
+
+        template<typename Rep, typename Period>
+        bool wait_for(const std::chrono::duration<Rep, Period>& dur) const {
+            if (!region_) return false;
+            auto deadline = std::chrono::steady_clock::now() +
+                            std::chrono::duration_cast<std::chrono::steady_clock::duration>(dur);
+            return wait(&deadline);
+        }
+
+        // Returns std::optional<T> with timeout
+        template<typename Rep, typename Period>
+        std::optional<T> get_for(const std::chrono::duration<Rep, Period>& dur) {
+            if (wait_for(dur)) return take();
+            return std::nullopt;
+        }
+
+        explicit operator bool() const noexcept { return (bool)region_; }
+    };
+
+    // Creates a fresh state in an anonymous memfd mapping.
+    static InterprocessOneShot create() {
+        int fd = ::memfd_create("oneshot", MFD_CLOEXEC);
+        if (fd < 0) throw_errno("memfd_create");
+        if (::ftruncate(fd, sizeof(Shared)) != 0) {
+            int err = errno;
+            ::close(fd);
+            errno = err;
+            throw_errno("ftruncate");
+        }
+        Shared* s = new (map(fd)) Shared;
+        auto region = std::make_shared<Region>(fd, s);
+
+        pthread_mutexattr_t attr;
+        ::pthread_mutexattr_init(&attr);
+        ::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        ::pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+        int rc = ::pthread_mutex_init(&s->liveness, &attr);
+        ::pthread_mutexattr_destroy(&attr);
+        if (rc != 0) throw std::system_error(rc, std::generic_category(), "pthread_mutex_init");
+        return InterprocessOneShot{std::move(region)};
+    }
+
+    // Maps a state created elsewhere. `fd` is duplicated; the caller keeps ownership of it.
+    static InterprocessOneShot attach(int fd) {
+        int own = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (own < 0) throw_errno("fcntl");
+        Shared* s = map(own);
+        return InterprocessOneShot{std::make_shared<Region>(own, s)};
+    }
+
+    // Descriptor of the backing mapping, valid for the lifetime of this object.
+    int fd() const noexcept { return region_ ? region_->fd : -1; }
+
+    // Attaches the sending side in the calling thread. Throws
+    // std::future_error(promise_already_satisfied) if a Sender was already attached.
+    Sender sender() {
+        Shared* s = region_->shm;
+        int rc = ::pthread_mutex_lock(&s->liveness);
+        if (rc == EOWNERDEAD) {
+            ::pthread_mutex_consistent(&s->liveness);
+        } else if (rc != 0) {
+            throw std::system_error(rc, std::generic_category(), "pthread_mutex_lock");
+        }
+        std::uint32_t expected = Empty;
+        if (!s->state.compare_exchange_strong(expected, Armed, std::memory_order_acq_rel)) {
+            ::pthread_mutex_unlock(&s->liveness);
+            oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::PromiseAlreadySatisfied);
+        }
+        futex_wake(s->state);
+        return Sender{region_};
+    }
+
+    Receiver receiver() { return Receiver{region_}; }
+};
@@ -0,0 +1,272 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define ONESHOT_LOCAL_COROUTINES 1
+#endif
+
+#include "OneShotValue.hpp"
+
+namespace oneshot_local {
+
+// Confinement policies: how LocalThreadOneShot checks that both ends stay on
+// the thread that made them.
+
+// No check; the default in NDEBUG builds.
+struct Unchecked {
+    void check_thread() const noexcept {}
+};
+
+// Aborts with a message when used from another thread; the default otherwise.
+struct CheckedThread {
+    std::thread::id owner = std::this_thread::get_id();
+
+    void check_thread() const noexcept {
+        if (std::this_thread::get_id() != owner) violation();
+    }
+
+private:
+    ONESHOT_NOINLINE static void violation() noexcept {
+        std::fprintf(stderr, "oneshot: LocalThreadOneShot used from a thread other than the one that made it\n");
+        std::fflush(stderr);
+        std::abort();
+    }
+};
+
+#if defined(NDEBUG)
+using DefaultConfinement = Unchecked;
+#else
+using DefaultConfinement = CheckedThread;
+#endif
+
+} // namespace oneshot_local
+
+//
+// OneShot for handoffs that never leave one thread (event-loop callbacks):
+// plain reference counts and flags instead of atomics, no mutex, no blocking
+// wait. A receiver either reads a result that is already there, registers a
+// continuation with then(), or is co_awaited (C++20); set_value() runs the
+// continuation or resumes the coroutine inline.
+//
+//   auto [s, r] = LocalThreadOneShot<int>::make();
+//   r.then([](LocalThreadOneShot<int>::Receiver done) { use(done.get()); });
+//   s.set_value(42);   // calls the continuation here
+//
+// get() throws std::logic_error when the result is not there yet, since
+// waiting on the only thread that could produce it would never return.
+// Dropping the Sender completes with broken_promise, as for OneShot.
+//
+// `Confinement` (see oneshot_local) checks that every call happens on the
+// thread that called make(): CheckedThread by default, Unchecked (nothing at
+// all) when NDEBUG is defined. Continuations up to two pointers in size are
+// stored in the state itself, so make() is the only allocation.
+//
+template<typename T, typename Confinement = oneshot_local::DefaultConfinement>
+class LocalThreadOneShot {
+    static constexpr bool is_void = std::is_void<T>::value;
+
+    struct State : oneshot_detail::Payload<T>, Confinement {
+        unsigned refs = 2;
+        bool set = false;
+        std::exception_ptr error;
+        // continuation registered by then() or co_await; run once, when set
+        void (*run)(State&) = nullptr;
+        alignas(void*) unsigned char slot[2 * sizeof(void*)];
+    };
+
+    static void release(State* s) noexcept {
+        if (s && --s->refs == 0) delete s;
+    }
+
+    template<typename F>
+    static constexpr bool fits_inline = sizeof(F) <= sizeof(State::slot) && alignof(F) <= alignof(void*) &&
+                                        std::is_nothrow_move_constructible<F>::value;
+
+public:
+    class Receiver;
+
+    class Sender : public oneshot_detail::SetValue<Sender, T> {
+        friend struct oneshot_detail::SetValue<Sender, T>;
+        friend class LocalThreadOneShot;
+        State* state_ = nullptr;
+
+        explicit Sender(State* s) noexcept : state_(s) {}
+
+    public:
+        using value_type = T;
+
+        Sender() = default;
+        Sender(Sender&& other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+        Sender& operator=(Sender&& other) noexcept {
+            if (this != &other) {
+                abandon();
+                release(std::exchange(state_, std::exchange(other.state_, nullptr)));
+            }
+            return *this;
+        }
+        Sender(const Sender&) = delete;
+        Sender& operator=(const Sender&) = delete;
+
+        ~Sender() {
+            abandon();
+            release(state_);
+        }
+
+        // bool set_value(T) / bool set_value(): see oneshot_detail::SetValue
+
+        bool set_exception(std::exception_ptr e) {
+            if (!state_ || state_->set) return false;
+            state_->check_thread();
+            state_->error = std::move(e);
+            complete();
+            return true;
+        }
+
+        explicit operator bool() const noexcept { return state_ != nullptr; }
+
+    private:
+        template<typename... V>
+        bool complete_value(V&&... v) {
+            if (!state_ || state_->set) return false;
+            state_->check_thread();
+            if constexpr (!is_void) state_->value.emplace(std::forward<V>(v)...);
+            complete();
+            return true;
+        }
+
+        void complete() {
+            state_->set = true;
+            if (state_->run) std::exchange(state_->run, nullptr)(*state_);
+        }
+
+        void abandon() noexcept {
+            if (!state_ || state_->set) return;
+            state_->check_thread();
+            state_->error = oneshot_detail::broken_promise();
+            complete();
+        }
+    };
+
+    class Receiver {
+        friend class LocalThreadOneShot;
+        State* state_ = nullptr;
+
+        explicit Receiver(State* s) noexcept : state_(s) {}
+
+    public:
+        using value_type = T;
+
+        Receiver() = default;
+        Receiver(Receiver&& other) noexcept : state_(std::exchange(other.state_, nullptr)) {}
+        Receiver& operator=(Receiver&& other) noexcept {
+            if (this != &other) release(std::exchange(state_, std::exchange(other.state_, nullptr)));
+            return *this;
+        }
+        Receiver(const Receiver&) = delete;
+        Receiver& operator=(const Receiver&) = delete;
+
+        ~Receiver() { release(state_); }
+
+        bool ready() const noexcept { return state_ && state_->set; }
+
+        // Consumes the result; it must be there already (see ready()).
+        T get() {
+            if (!state_) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+            state_->check_thread();
+            if (!state_->set) not_ready();
+            struct Drop {
+                State* s;
+                ~Drop() { release(s); }
+            } drop{std::exchange(state_, nullptr)};
+            if (drop.s->error) std::rethrow_exception(drop.s->error);
+            if constexpr (!is_void) return std::move(*drop.s->value);
+        }
+
+        // Calls f(Receiver) with this receiver once the result is there: right
+        // away if it already is, otherwise from inside set_value() (or the
+        // Sender's destructor). Consumes the receiver.
+        template<typename F>
+        void then(F&& f) {
+            if (!state_) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+            state_->check_thread();
+            if (state_->set) {
+                std::forward<F>(f)(std::move(*this));
+                return;
+            }
+            using Fn = std::decay_t<F>;
+            State& s = *state_;
+            if constexpr (fits_inline<Fn>) {
+                ::new (static_cast<void*>(s.slot)) Fn(std::forward<F>(f));
+                s.run = [](State& st) {
+                    Fn* stored = std::launder(reinterpret_cast<Fn*>(st.slot));
+                    Fn fn(std::move(*stored));
+                    stored->~Fn();
+                    fn(Receiver(&st));
+                };
+            } else {
+                ::new (static_cast<void*>(s.slot)) Fn*(new Fn(std::forward<F>(f)));
+                s.run = [](State& st) {
+                    Fn* fn = *std::launder(reinterpret_cast<Fn**>(st.slot));
+                    struct Free {
+                        Fn* p;
+                        ~Free() { delete p; }
+                    } free{fn};
+                    (*fn)(Receiver(&st));
+                };
+            }
+            state_ = nullptr;  // the continuation owns this reference now
+        }
+
+#if defined(ONESHOT_LOCAL_COROUTINES)
+        // co_await receiver: resumes the coroutine from inside set_value().
+        auto operator co_await() noexcept {
+            struct Awaiter {
+                Receiver& r;
+
+                // a coroutine destroyed while suspended here must not be resumed
+                ~Awaiter() {
+                    if (r.state_ && !r.state_->set) r.state_->run = nullptr;
+                }
+
+                bool await_ready() const noexcept { return !r.state_ || r.state_->set; }
+                void await_suspend(std::coroutine_handle<> h) noexcept {
+                    r.state_->check_thread();
+                    ::new (static_cast<void*>(r.state_->slot)) void*(h.address());
+                    r.state_->run = [](State& st) {
+                        std::coroutine_handle<>::from_address(*std::launder(reinterpret_cast<void**>(st.slot)))
+                            .resume();
+                    };
+                }
+                T await_resume() { return r.get(); }
+            };
+            return Awaiter{*this};
+        }
+#endif
+
+        explicit operator bool() const noexcept { return state_ != nullptr; }
+
+    private:
+        ONESHOT_NOINLINE static void not_ready() {
+            throw std::logic_error("LocalThreadOneShot: get() before the result was set");
+        }
+    };
+
+    static std::pair<Sender, Receiver> make() {
+        auto* s = new State;
+        return {Sender(s), Receiver(s)};
+    }
+};
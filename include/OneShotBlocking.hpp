@@ -0,0 +1,113 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__has_include)
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define ONESHOT_HAVE_BACKTRACE 1
+#endif
+#endif
+
+//
+// Detector for blocking receiver waits on threads that must never block
+// (event loops, reactor threads).
+//
+// A thread opts in with mark_nonblocking_thread(). From then on, a get() that
+// would actually block, or a get_for()/wait_for() longer than the configured
+// budget, on a OneShot or OneShotChannel receiver counts as a violation and
+// triggers the configured action:
+//
+//   Action::Count   increment violations() only (default)
+//   Action::Log     also print the call and a stack trace to stderr
+//   Action::Abort   log, then abort; in NDEBUG builds this behaves like Log
+//
+// Waits that park a fiber instead of the thread are not violations. On
+// unmarked threads the check is one thread-local load.
+//
+namespace oneshot_blocking {
+
+enum class Action { Count, Log, Abort };
+
+namespace detail {
+
+inline bool& marked() noexcept {
+    static thread_local bool flag = false;
+    return flag;
+}
+
+inline std::atomic<Action>& action() noexcept {
+    static std::atomic<Action> a{Action::Count};
+    return a;
+}
+
+inline std::atomic<std::int64_t>& budget_ns() noexcept {
+    static std::atomic<std::int64_t> ns{0};
+    return ns;
+}
+
+inline std::atomic<std::uint64_t>& violations() noexcept {
+    static std::atomic<std::uint64_t> n{0};
+    return n;
+}
+
+inline void log(const char* what) noexcept {
+    std::fprintf(stderr, "oneshot: blocking %s on a non-blocking thread\n", what);
+#if defined(ONESHOT_HAVE_BACKTRACE)
+    void* frames[64];
+    int n = backtrace(frames, 64);
+    backtrace_symbols_fd(frames, n, 2);
+#endif
+    std::fflush(stderr);
+}
+
+inline void report(const char* what) noexcept {
+    violations().fetch_add(1, std::memory_order_relaxed);
+    Action a = action().load(std::memory_order_relaxed);
+    if (a == Action::Count) return;
+    log(what);
+#if !defined(NDEBUG)
+    if (a == Action::Abort) std::abort();
+#endif
+}
+
+} // namespace detail
+
+// Tags (or untags) the calling thread as one that must not block.
+inline void mark_nonblocking_thread(bool on = true) noexcept { detail::marked() = on; }
+
+inline bool is_nonblocking_thread() noexcept { return detail::marked(); }
+
+inline void set_action(Action a) noexcept { detail::action().store(a, std::memory_order_relaxed); }
+
+// Timed waits up to `budget` are tolerated on marked threads (default: none).
+inline void set_timed_wait_budget(std::chrono::nanoseconds budget) noexcept {
+    detail::budget_ns().store(budget.count(), std::memory_order_relaxed);
+}
+
+// Number of violations so far, in all threads.
+inline std::uint64_t violations() noexcept { return detail::violations().load(std::memory_order_relaxed); }
+
+// Called before a wait without deadline; `ready()` is evaluated on marked threads only.
+template<typename Ready>
+void check_wait(Ready&& ready) noexcept {
+    if (detail::marked() && !ready()) detail::report("get()");
+}
+
+// Called before a wait of `timeout`; `ready()` is evaluated on marked threads only.
+template<typename Ready>
+void check_timed_wait(std::chrono::nanoseconds timeout, Ready&& ready) noexcept {
+    if (detail::marked() && timeout.count() > detail::budget_ns().load(std::memory_order_relaxed) && !ready()) {
+        detail::report("timed wait");
+    }
+}
+
+} // namespace oneshot_blocking
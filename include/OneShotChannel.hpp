@@ -1,247 +1,362 @@
 #pragma once
 
-#include <future>
 #include <memory>
 #include <atomic>
-#include <optional>
+#include <cstddef>
+#include <cstdint>
 #include <chrono>
+#include <condition_variable>
 #include <exception>
 #include <mutex>
+#include <type_traits>
+#include <utility>
 
+#include "OneShotValue.hpp"
+#include "OneShotWait.hpp"
+#include "OneShotObserver.hpp"
+#include "OneShotProbes.hpp"
+#include "OneShotBlocking.hpp"
+
+//
+// Operational counters of a channel. Each end of a channel counts into its own
+// set of relaxed atomics, and stats() adds the two up; after enable_global()
+// they are also summed into a process-wide aggregate. Read them with
+// Sender::stats() / Receiver::stats().
+//
+struct OneShotChannelStats {
+    std::uint64_t sets = 0;                  // successful set_value / set_exception
+    std::uint64_t rejected_sets = 0;         // set_* on an already completed channel
+    std::uint64_t resets = 0;
+    std::uint64_t broken = 0;                // senders dropped or replaced without setting
+    std::uint64_t timeouts = 0;              // get_for calls that timed out
+    std::uint64_t late_values = 0;           // ... and whose value was set afterwards
+    std::uint64_t swallowed_exceptions = 0;  // exceptions get_for turned into "no value"
+    std::uint64_t lock_acquisitions = 0;
+    std::uint64_t contended_locks = 0;       // acquisitions that found the mutex held
+
+    static void enable_global(bool on = true) noexcept;
+    static OneShotChannelStats global() noexcept;
+};
+
+namespace oneshot_channel_detail {
+
+enum Counter : std::size_t {
+    Sets, RejectedSets, Resets, Broken, Timeouts, LateValues, SwallowedExceptions, LockAcquisitions,
+    ContendedLocks, NumCounters
+};
+
+struct Counters {
+    std::atomic<std::uint64_t> n[NumCounters] = {};
+
+    void add(Counter c) noexcept {
+        n[c].fetch_add(1, std::memory_order_relaxed);
+        if (global_enabled().load(std::memory_order_relaxed)) global().n[c].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Adds these counts to `s`.
+    void add_to(OneShotChannelStats& s) const noexcept {
+        auto get = [this](Counter c) { return n[c].load(std::memory_order_relaxed); };
+        s.sets += get(Sets);
+        s.rejected_sets += get(RejectedSets);
+        s.resets += get(Resets);
+        s.broken += get(Broken);
+        s.timeouts += get(Timeouts);
+        s.late_values += get(LateValues);
+        s.swallowed_exceptions += get(SwallowedExceptions);
+        s.lock_acquisitions += get(LockAcquisitions);
+        s.contended_locks += get(ContendedLocks);
+    }
+
+    OneShotChannelStats snapshot() const noexcept {
+        OneShotChannelStats s;
+        add_to(s);
+        return s;
+    }
+
+    static Counters& global() noexcept {
+        static Counters g;
+        return g;
+    }
+    static std::atomic<bool>& global_enabled() noexcept {
+        static std::atomic<bool> on{false};
+        return on;
+    }
+};
+
+// Locks `mtx`, counting the acquisition and whether it had to wait for it.
+inline std::unique_lock<std::mutex> lock(std::mutex& mtx, Counters& c) {
+    std::unique_lock<std::mutex> l(mtx, std::try_to_lock);
+    c.add(LockAcquisitions);
+    if (!l.owns_lock()) {
+        c.add(ContendedLocks);
+        l.lock();
+    }
+    return l;
+}
+
+} // namespace oneshot_channel_detail
+
+//
+// Memory layout policies for the shared state of a OneShotChannel.
+//
+// Packed (default) keeps all fields together, so a channel costs only the
+// memory it needs. CacheAligned starts the lock, the sender-written fields
+// (result, used, the sender's counters) and the receiver-side fields
+// (generation, timed_out, waiters, the receivers' counters) on separate cache
+// lines, and aligns the state itself to a line. The two sides
+// then stop invalidating each other's line, and states allocated next to each
+// other (channels kept in arrays) no longer false-share. It costs a few lines
+// per channel.
 //
-// A resettable "one-shot" channel using std::promise/std::future under the hood
-// C++17-compatible
+namespace oneshot_layout {
+
+struct Packed {
+    static constexpr std::size_t align = 0;
+};
+
+struct CacheAligned {
+    static constexpr std::size_t align = cache_line;
+};
+
+// `Fields` aligned to `Align` bytes; 0 leaves its layout alone.
+template<std::size_t Align, typename Fields>
+struct alignas(Align) Aligned : Fields {
+    using Fields::Fields;
+};
+template<typename Fields>
+struct Aligned<0, Fields> : Fields {
+    using Fields::Fields;
+};
+
+} // namespace oneshot_layout
+
+inline void OneShotChannelStats::enable_global(bool on) noexcept {
+    oneshot_channel_detail::Counters::global_enabled().store(on, std::memory_order_relaxed);
+}
+
+inline OneShotChannelStats OneShotChannelStats::global() noexcept {
+    return oneshot_channel_detail::Counters::global().snapshot();
+}
+
+//
+// A resettable "one-shot" channel. C++17-compatible
 //
-// Thread safety: Senders serialize via promise operations. Receivers use shared_future
-// with copy-under-lock pattern to allow safe concurrent reset() without data races.
-template<typename T>
+// Each generation is set once, with a value or an exception, and can be read
+// by any number of get()/get_for() calls until reset() starts the next one.
+// The result lives inline in the shared state, so sets, reads and resets do
+// not allocate. Readers copy it out under the channel lock, which makes
+// reset() safe while other threads wait in get() or call set_value(). A reset
+// discards the current generation: receivers still waiting for it see
+// broken_promise, as for a dropped Sender (get_for: no value). Receivers block
+// the thread.
+//
+// `Observer` is a compile-time hook policy (see OneShotObserver.hpp); the default
+// compiles to nothing. `Layout` is oneshot_layout::Packed (default) or
+// oneshot_layout::CacheAligned.
+//
+// OneShotChannel<T>: Sender::set_value(T), Receiver::get() -> T, get_for() -> std::optional<T>
+// OneShotChannel<void>: Sender::set_value(), Receiver::get(), get_for() -> bool
+template<typename T, typename Observer = NullObserver, typename Layout = oneshot_layout::Packed>
 class OneShotChannel {
+    static constexpr bool is_void = std::is_void<T>::value;
+
 public:
     class Sender;
     class Receiver;
 
 private:
-    struct Shared {
+    struct LockFields {
         std::mutex mtx;
-        std::promise<T> promise;
-        std::shared_future<T> future;  // shared_future allows multiple concurrent readers
-        bool used = false;
-
-        Shared() : future(promise.get_future().share()) {}
-
-        void reset_locked() {
-            promise = std::promise<T>();
-            future = promise.get_future().share();
-            used = false;
-        }
+        std::condition_variable cv;  // receivers, a set_value_and_wait() sender, remove_waiter()
+        int notifying = 0;  // waiter lists being notified outside the lock
+        // set_value_and_wait(): a sender waits for the current generation to be taken
+        std::atomic<bool> sender_waits{false};
+        oneshot_detail::WaitNode* sender_node = nullptr;  // ... parked as a fiber
+        RendezvousResult* handoff = nullptr;     // ... and gets its outcome here, once
+        std::atomic<bool> receiver_gone{false};  // the Receiver was destroyed or replaced
     };
+    // written by senders
+    struct ProducerFields : oneshot_detail::Payload<T> {
+        oneshot_channel_detail::Counters sender_counters;
+        std::exception_ptr error;
+        bool used = false;         // the current generation is set
+        bool broken = false;       // ... by a Sender dropped without setting it
+        bool sender_gone = false;  // the Sender was destroyed or replaced
+    };
+    // read by receivers; rewritten by reset()
+    struct ConsumerFields {
+        oneshot_channel_detail::Counters receiver_counters;
+        std::uint64_t generation = 0;  // bumped by every reset
+        bool timed_out = false;        // a get_for gave up on the current generation
+        int blocked = 0;               // receivers waiting on cv
+        oneshot_detail::WaitNode* waiters = nullptr;  // see add_waiter
+    };
+    template<typename Fields>
+    using Line = oneshot_layout::Aligned<Layout::align, Fields>;
 
-    std::shared_ptr<Shared> state_;
-
-    explicit OneShotChannel(std::shared_ptr<Shared> s) : state_(std::move(s)) {}
+    struct Shared : Observer::Data, Line<LockFields>, Line<ProducerFields>, Line<ConsumerFields> {
+        // Each end counts into its own block, on its own line with CacheAligned.
+        std::unique_lock<std::mutex> lock(oneshot_channel_detail::Counters& side) {
+            return oneshot_channel_detail::lock(this->mtx, side);
+        }
 
-public:
-    static std::pair<Sender, Receiver> make() {
-        auto s = std::make_shared<Shared>();
-        return {Sender{s}, Receiver{s}};
-    }
+        OneShotChannelStats stats() const noexcept {
+            OneShotChannelStats s;
+            this->sender_counters.add_to(s);
+            this->receiver_counters.add_to(s);
+            return s;
+        }
 
-    //
-    // Sending side
-    //
-    class Sender {
-        std::shared_ptr<Shared> state_;
-    public:
-        Sender() = default;
-        explicit Sender(std::shared_ptr<Shared> s) : state_(std::move(s)) {}
+        // `side`: the counters of the end that called reset()
+        void reset_locked(oneshot_channel_detail::Counters& side) {
+            Observer::on_reset(*this);
+            ONESHOT_PROBE1(oneshot_channel, reset, this);
+            side.add(oneshot_channel_detail::Resets);
+            if constexpr (!is_void) this->value.reset();
+            this->error = nullptr;
+            this->used = false;
+            this->broken = false;
+            this->timed_out = false;
+            ++this->generation;
+            hand_off_locked(RendezvousResult::Discarded);  // the value was never read
+            if (this->blocked) this->cv.notify_all();      // their generation is gone
+        }
 
-        Sender(Sender&&) noexcept = default;
-        Sender& operator=(Sender&& other) noexcept {
-            if (this != &other) {
-                // If current sender has state and is being replaced, set broken promise
-                if (state_) {
-                    std::lock_guard<std::mutex> lock(state_->mtx);
-                    if (!state_->used) {
-                        try {
-                            state_->promise.set_exception(std::make_exception_ptr(
-                                std::future_error(std::future_errc::broken_promise)));
-                            state_->used = true;
-                        } catch (...) {}
-                    }
-                }
-                state_ = std::move(other.state_);
+        // Waits, with the lock held, until generation `gen` is set or reset;
+        // false if `deadline` (if given) passed first.
+        bool wait_set_locked(std::unique_lock<std::mutex>& lock, std::uint64_t gen,
+                             const std::chrono::steady_clock::time_point* deadline) {
+            auto done = [&] { return this->used || this->generation != gen; };
+            if (done()) return true;
+            if (!deadline) oneshot_blocking::check_wait([] { return false; });
+            else oneshot_blocking::check_timed_wait(*deadline - std::chrono::steady_clock::now(), [] { return false; });
+            ++this->blocked;
+            while (!done()) {
+                if (!deadline) this->cv.wait(lock);
+                else if (this->cv.wait_until(lock, *deadline) == std::cv_status::timeout) break;
             }
-            return *this;
+            --this->blocked;
+            return done();
         }
-        Sender(const Sender&) = delete;
-        Sender& operator=(const Sender&) = delete;
 
-        ~Sender() {
-            if (state_) {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                if (!state_->used) {
-                    try {
-                        state_->promise.set_exception(std::make_exception_ptr(
-                            std::future_error(std::future_errc::broken_promise)));
-                        state_->used = true;
-                    } catch (...) {}
-                }
+        // Copies out the result of generation `gen`, which is set or was
+        // reset. False if there is none to read: the generation was reset
+        // before this read, or broken by a dropped Sender.
+        bool read_locked(std::uint64_t gen, oneshot_detail::Payload<T>& out, std::exception_ptr& error) {
+            if (gen != this->generation || this->broken) return false;
+            if (this->error) {
+                error = this->error;
+                return true;
             }
+            if constexpr (!is_void) out.value.emplace(*this->value);
+            hand_off_locked(RendezvousResult::Consumed);
+            return true;
         }
 
-        bool set_value(T value) {
-            if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            if (state_->used) return false;
-            state_->used = true;
-            state_->promise.set_value(std::move(value));
-            return true;
+        // Tells a sender waiting in set_value_and_wait() how its value ended.
+        void hand_off_locked(RendezvousResult r) noexcept {
+            if (!this->handoff) return;
+            *std::exchange(this->handoff, nullptr) = r;
+            oneshot_detail::wake_slot(this->sender_node, this->cv);
         }
 
-        bool set_exception(std::exception_ptr e) {
-            if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            if (state_->used) return false;
-            state_->used = true;
-            state_->promise.set_exception(std::move(e));
-            return true;
+        // Locks only if a sender waits: each side stores its flag, then loads
+        // the other's (seq_cst), so at least one of them sees both.
+        void drop_receiver() {
+            this->receiver_gone.store(true, std::memory_order_seq_cst);
+            if (!this->sender_waits.load(std::memory_order_seq_cst)) return;
+            auto l = lock(this->receiver_counters);
+            hand_off_locked(RendezvousResult::ReceiverGone);
         }
 
-        bool reset() {
-            if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            state_->reset_locked();
+        // Intrusive waiters, as on oneshot_detail::Core (used by OneShotSelect.hpp
+        // and OneShotStream.hpp): `notify` runs once the current generation is set
+        // or broken, on that thread and outside the channel lock. It must not
+        // remove other nodes from the same channel. Returns false (and does not
+        // link) if already set.
+        bool add_waiter(oneshot_detail::WaitNode& node) {
+            auto l = lock(this->receiver_counters);
+            if (this->used) return false;
+            node.prev = nullptr;
+            node.next = this->waiters;
+            if (this->waiters) this->waiters->prev = &node;
+            this->waiters = &node;
+            node.linked = true;
             return true;
         }
 
-        explicit operator bool() const noexcept { return (bool)state_; }
-    };
-
-    //
-    // Receiving side
-    //
-    class Receiver {
-        std::shared_ptr<Shared> state_;
-    public:
-        Receiver() = default;
-        explicit Receiver(std::shared_ptr<Shared> s) : state_(std::move(s)) {}
-
-        Receiver(Receiver&&) noexcept = default;
-        Receiver& operator=(Receiver&&) noexcept = default;
-        Receiver(const Receiver&) = delete;
-        Receiver& operator=(const Receiver&) = delete;
-
-        T get() {
-            // Copy future under lock to avoid race with reset()
-            if (!state_) throw std::future_error(std::future_errc::no_state);
-            std::shared_future<T> local;
-            {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                local = state_->future;
+        // Unlinks `node` if still pending and returns true if it did. Once this
+        // returns, `notify` is not running and will not run for it.
+        bool remove_waiter(oneshot_detail::WaitNode& node) {
+            auto l = lock(this->receiver_counters);
+            if (!node.linked) {
+                while (this->notifying) this->cv.wait(l);
+                return false;
             }
-            return local.get();
+            if (node.prev) node.prev->next = node.next;
+            else this->waiters = node.next;
+            if (node.next) node.next->prev = node.prev;
+            node.linked = false;
+            return true;
         }
 
-        bool ready() const {
-            // Copy future under lock to avoid race with reset()
-            if (!state_) return false;
-            using namespace std::chrono_literals;
-            std::shared_future<T> local;
-            {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                local = state_->future;
-            }
-            return local.wait_for(0s) == std::future_status::ready;
+        // Detaches the waiters of a generation that was just set; hand the
+        // result to notify_waiters() once the lock is released.
+        oneshot_detail::WaitNode* take_waiters_locked() noexcept {
+            oneshot_detail::WaitNode* list = std::exchange(this->waiters, nullptr);
+            for (oneshot_detail::WaitNode* n = list; n; n = n->next) n->linked = false;
+            if (list) ++this->notifying;
+            return list;
         }
 
-        template<typename Rep, typename Period>
-        std::optional<T> get_for(const std::chrono::duration<Rep, Period>& dur) {
-            // Copy future under lock to avoid race with reset().
-            // If an exception occurs (e.g., broken_promise during concurrent reset),
-            // it is swallowed and std::nullopt is returned (same as timeout).
-            if (!state_) return std::nullopt;
-            std::shared_future<T> local;
-            {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                local = state_->future;
+        void notify_waiters(oneshot_detail::WaitNode* list) {
+            if (!list) return;
+            while (list) {
+                oneshot_detail::WaitNode* next = list->next;  // `notify` may destroy the node
+                list->notify(list);
+                list = next;
             }
-            if (local.wait_for(dur) == std::future_status::ready) {
-                try {
-                    return local.get();
-                } catch (...) {
-                    // Treat broken/exceptional state as not available under timed get
-                    return std::nullopt;
-                }
+            {
+                auto l = lock(this->sender_counters);  // only senders notify
+                --this->notifying;
             }
-            return std::nullopt;
+            this->cv.notify_all();
         }
 
-        bool reset() {
-            if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            state_->reset_locked();
-            return true;
-        }
-
-        explicit operator bool() const noexcept { return (bool)state_; }
-    };
-};
-
-
-//
-// void specialization
-//
-// Same thread-safety model as OneShotChannel<T>.
-template<>
-class OneShotChannel<void> {
-public:
-    class Sender;
-    class Receiver;
-
-private:
-    struct Shared {
-        std::mutex mtx;
-        std::promise<void> promise;
-        std::shared_future<void> future;  // shared_future allows multiple concurrent readers
-        bool used = false;
-
-        Shared() : future(promise.get_future().share()) {}
-
-        void reset_locked() {
-            promise = std::promise<void>();
-            future = promise.get_future().share();
-            used = false;
+        // Called with the lock held once a set_* has been accepted.
+        void count_set_locked() {
+            this->sender_counters.add(oneshot_channel_detail::Sets);
+            if (this->timed_out) this->sender_counters.add(oneshot_channel_detail::LateValues);
         }
     };
 
     std::shared_ptr<Shared> state_;
+
     explicit OneShotChannel(std::shared_ptr<Shared> s) : state_(std::move(s)) {}
 
 public:
     static std::pair<Sender, Receiver> make() {
         auto s = std::make_shared<Shared>();
+        Observer::on_create(*s);
         return {Sender{s}, Receiver{s}};
     }
 
-    class Sender {
+    //
+    // Sending side
+    //
+    class Sender : public oneshot_detail::SetValue<Sender, T>, public oneshot_detail::SetValueAndWait<Sender, T> {
+        friend struct oneshot_detail::SetValue<Sender, T>;
+        friend struct oneshot_detail::SetValueAndWait<Sender, T>;
         std::shared_ptr<Shared> state_;
     public:
         Sender() = default;
         explicit Sender(std::shared_ptr<Shared> s) : state_(std::move(s)) {}
+
         Sender(Sender&&) noexcept = default;
         Sender& operator=(Sender&& other) noexcept {
             if (this != &other) {
                 // If current sender has state and is being replaced, set broken promise
-                if (state_) {
-                    std::lock_guard<std::mutex> lock(state_->mtx);
-                    if (!state_->used) {
-                        try {
-                            state_->promise.set_exception(std::make_exception_ptr(
-                                std::future_error(std::future_errc::broken_promise)));
-                            state_->used = true;
-                        } catch (...) {}
-                    }
-                }
+                abandon();
                 state_ = std::move(other.state_);
             }
             return *this;
@@ -249,112 +364,232 @@ public:
         Sender(const Sender&) = delete;
         Sender& operator=(const Sender&) = delete;
 
-        ~Sender() {
-            if (state_) {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                if (!state_->used) {
-                    try {
-                        state_->promise.set_exception(std::make_exception_ptr(
-                            std::future_error(std::future_errc::broken_promise)));
-                        state_->used = true;
-                    } catch (...) {}
-                }
-            }
+        ~Sender() { abandon(); }
+
+        // bool set_value(T) / bool set_value(): see oneshot_detail::SetValue
+        //
+        // RendezvousResult set_value_and_wait(T) / set_value_and_wait_for(T, d):
+        // sets the value, then waits (parking a fiber) until a receiver read it
+        // with get()/get_for() (Consumed), the generation was reset before any
+        // read (Discarded), or the Receiver was dropped (ReceiverGone); see
+        // oneshot_detail::SetValueAndWait.
+
+        bool set_exception(std::exception_ptr e) {
+            return complete(1, [&](Shared& st) { st.error = std::move(e); });
         }
 
-        bool set_value() {
+        bool reset() {
             if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            if (state_->used) return false;
-            state_->used = true;
-            state_->promise.set_value();
+            auto lock = state_->lock(state_->sender_counters);
+            state_->reset_locked(state_->sender_counters);
             return true;
         }
 
-        bool set_exception(std::exception_ptr e) {
-            if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            if (state_->used) return false;
-            state_->used = true;
-            state_->promise.set_exception(std::move(e));
-            return true;
+        OneShotChannelStats stats() const {
+            return state_ ? state_->stats() : OneShotChannelStats{};
         }
 
-        bool reset() {
+        explicit operator bool() const noexcept { return (bool)state_; }
+
+    private:
+        template<typename... V>
+        bool complete_value(V&&... v) {
+            return complete(0, [&](auto& st) {
+                if constexpr (!is_void) st.value.emplace(std::forward<V>(v)...);
+            });
+        }
+
+        template<typename... V>
+        RendezvousResult complete_and_wait(const std::chrono::steady_clock::time_point* deadline, V&&... v) {
+            // TimedOut until a receiver, reset() or drop_receiver() hands off
+            RendezvousResult result = RendezvousResult::TimedOut;
+            auto fulfil = [&](auto& st) {
+                if constexpr (!is_void) st.value.emplace(std::forward<V>(v)...);
+            };
+            if (!complete(0, fulfil, &result)) return RendezvousResult::Rejected;
+            auto& st = *state_;
+            auto lock = st.lock(st.sender_counters);
+            oneshot_detail::wait_locked(lock, st.cv, st.sender_node,
+                                        [&] { return result != RendezvousResult::TimedOut; }, deadline);
+            if (st.handoff == &result) st.handoff = nullptr;
+            // after a reset, a later set_value_and_wait may own the handoff: keep its flag
+            if (!st.handoff) st.sender_waits.store(false, std::memory_order_relaxed);
+            return result;
+        }
+
+        // `handoff`: set_value_and_wait, which waits for the outcome written there
+        template<typename Fulfil>
+        bool complete(int is_exception, Fulfil&& fulfil, RendezvousResult* handoff = nullptr) {
             if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            state_->reset_locked();
+            oneshot_detail::WaitNode* waiters;
+            bool wake;
+            {
+                auto lock = state_->lock(state_->sender_counters);
+                if (state_->used) {
+                    state_->sender_counters.add(oneshot_channel_detail::RejectedSets);
+                    return false;
+                }
+                fulfil(*state_);  // a throwing copy leaves the generation unset
+                state_->used = true;
+                if (handoff) {
+                    state_->handoff = handoff;
+                    state_->sender_waits.store(true, std::memory_order_seq_cst);  // see drop_receiver
+                    if (state_->receiver_gone.load(std::memory_order_seq_cst)) {
+                        state_->hand_off_locked(RendezvousResult::ReceiverGone);
+                    }
+                }
+                state_->count_set_locked();
+                Observer::on_set(*state_);
+                ONESHOT_PROBE2(oneshot_channel, set, state_.get(), is_exception);
+                (void)is_exception;  // only read by the probe
+                waiters = state_->take_waiters_locked();
+                wake = state_->blocked != 0;
+            }
+            if (wake) state_->cv.notify_all();
+            state_->notify_waiters(waiters);
             return true;
         }
 
-        explicit operator bool() const noexcept { return (bool)state_; }
+        // Breaks an unset generation. Receivers raise broken_promise when they
+        // read it, so nothing is allocated here.
+        ONESHOT_NOINLINE void abandon() noexcept {
+            if (!state_) return;
+            oneshot_detail::WaitNode* waiters = nullptr;
+            bool wake = false;
+            try {
+                {
+                    auto lock = state_->lock(state_->sender_counters);
+                    state_->sender_gone = true;
+                    if (!state_->used) {
+                        state_->used = true;
+                        state_->broken = true;
+                        state_->sender_counters.add(oneshot_channel_detail::Broken);
+                        Observer::on_broken(*state_);
+                        ONESHOT_PROBE1(oneshot_channel, broken, state_.get());
+                        waiters = state_->take_waiters_locked();
+                        wake = state_->blocked != 0;
+                    }
+                }
+                if (wake) state_->cv.notify_all();
+                state_->notify_waiters(waiters);
+            } catch (...) {}  // the lock could not be taken
+        }
     };
 
+    //
+    // Receiving side
+    //
     class Receiver {
+        friend struct oneshot_detail::Access;
         std::shared_ptr<Shared> state_;
     public:
         Receiver() = default;
         explicit Receiver(std::shared_ptr<Shared> s) : state_(std::move(s)) {}
 
         Receiver(Receiver&&) noexcept = default;
-        Receiver& operator=(Receiver&&) noexcept = default;
+        Receiver& operator=(Receiver&& other) noexcept {
+            if (this != &other) {
+                release();
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
         Receiver(const Receiver&) = delete;
         Receiver& operator=(const Receiver&) = delete;
 
-        void get() {
-            // Copy future under lock to avoid race with reset()
-            if (!state_) throw std::future_error(std::future_errc::no_state);
-            std::shared_future<void> local;
+        ~Receiver() { release(); }
+
+        // Returns a copy of the current generation's value once it is set; the
+        // generation stays readable until reset.
+        T get() {
+            if (!state_) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+            auto& st = *state_;
+            std::uint64_t t0 = Observer::now();
+            Observer::on_wait(st);
+            ONESHOT_PROBE1(oneshot_channel, block, state_.get());
+            oneshot_detail::Payload<T> result;
+            std::exception_ptr error;
+            bool read;
             {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                local = state_->future;
+                auto lock = st.lock(st.receiver_counters);
+                std::uint64_t gen = st.generation;
+                st.wait_set_locked(lock, gen, nullptr);
+                read = st.read_locked(gen, result, error);
             }
-            local.get();
+            ONESHOT_PROBE2(oneshot_channel, wake, state_.get(), 1);
+            Observer::on_wake(st, t0);
+            Observer::on_consume(st);
+            if (!read) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::BrokenPromise);
+            if (error) std::rethrow_exception(error);
+            if constexpr (!is_void) return std::move(*result.value);
         }
 
         bool ready() const {
-            // Copy future under lock to avoid race with reset()
             if (!state_) return false;
-            using namespace std::chrono_literals;
-            std::shared_future<void> local;
-            {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                local = state_->future;
-            }
-            return local.wait_for(0s) == std::future_status::ready;
+            auto lock = state_->lock(state_->receiver_counters);
+            return state_->used;
         }
 
+        // std::optional<T> (or bool for void); empty on timeout
         template<typename Rep, typename Period>
-        bool get_for(const std::chrono::duration<Rep, Period>& dur) {
-            // Copy future under lock to avoid race with reset().
-            // If an exception occurs (e.g., broken_promise during concurrent reset),
-            // it is swallowed and false is returned (same as timeout).
-            if (!state_) return false;
-            std::shared_future<void> local;
+        oneshot_detail::TimedResult<T> get_for(const std::chrono::duration<Rep, Period>& dur) {
+            // An exception (including broken_promise, from a dropped Sender or a
+            // reset while waiting) is swallowed: the result is empty, as on timeout.
+            if (!state_) return {};
+            auto& st = *state_;
+            auto deadline = std::chrono::steady_clock::now() +
+                            std::chrono::duration_cast<std::chrono::steady_clock::duration>(dur);
+            std::uint64_t t0 = Observer::now();
+            Observer::on_wait(st);
+            ONESHOT_PROBE1(oneshot_channel, block, state_.get());
+            oneshot_detail::Payload<T> result;
+            std::exception_ptr error;
+            bool ready, read = false;
             {
-                std::lock_guard<std::mutex> lock(state_->mtx);
-                local = state_->future;
-            }
-            if (local.wait_for(dur) == std::future_status::ready) {
-                try {
-                    local.get();
-                    return true;
-                } catch (...) {
-                    // Treat broken/exceptional state as not available under timed get
-                    return false;
+                auto lock = st.lock(st.receiver_counters);
+                std::uint64_t gen = st.generation;
+                ready = st.wait_set_locked(lock, gen, &deadline);
+                if (ready) {
+                    read = st.read_locked(gen, result, error);
+                } else {
+                    st.receiver_counters.add(oneshot_channel_detail::Timeouts);
+                    st.timed_out = true;  // a value set from now on is late
                 }
             }
-            return false;
+            ONESHOT_PROBE2(oneshot_channel, wake, state_.get(), ready);
+            if (!ready) {
+                Observer::on_timeout(st, t0);
+                return {};
+            }
+            Observer::on_wake(st, t0);
+            Observer::on_consume(st);
+            if (!read || error) {
+                st.receiver_counters.add(oneshot_channel_detail::SwallowedExceptions);
+                return {};
+            }
+            if constexpr (is_void) return true;
+            else return std::move(result.value);
         }
 
         bool reset() {
             if (!state_) return false;
-            std::lock_guard<std::mutex> lock(state_->mtx);
-            state_->reset_locked();
+            auto lock = state_->lock(state_->receiver_counters);
+            state_->reset_locked(state_->receiver_counters);
             return true;
         }
 
+        OneShotChannelStats stats() const {
+            return state_ ? state_->stats() : OneShotChannelStats{};
+        }
+
         explicit operator bool() const noexcept { return (bool)state_; }
+
+    private:
+        void release() noexcept {
+            if (!state_) return;
+            try {
+                state_->drop_receiver();
+            } catch (...) {}  // the lock could not be taken; nobody is told
+        }
     };
 };
-
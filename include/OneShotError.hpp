@@ -0,0 +1,49 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <exception>
+#include <future>
+
+// The one-shots report errors as std::future_error, like std::promise does.
+// Only the error type is used; the state and waiting are the library's own.
+
+// Keeps cold paths (broken promise, ...) out of line so they are emitted once
+// per instantiation rather than inlined into every destructor.
+#if defined(__GNUC__) || defined(__clang__)
+#define ONESHOT_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define ONESHOT_NOINLINE __declspec(noinline)
+#else
+#define ONESHOT_NOINLINE
+#endif
+
+namespace oneshot_detail {
+
+// The std::future_errc values the one-shots raise.
+enum class FutureErrc { PromiseAlreadySatisfied, NoState, BrokenPromise };
+
+// Throws std::future_error with the matching std::future_errc.
+[[noreturn]] ONESHOT_NOINLINE inline void throw_future_error(FutureErrc e) {
+    switch (e) {
+    case FutureErrc::PromiseAlreadySatisfied:
+        throw std::future_error(std::future_errc::promise_already_satisfied);
+    case FutureErrc::NoState:
+        throw std::future_error(std::future_errc::no_state);
+    default:
+        throw std::future_error(std::future_errc::broken_promise);
+    }
+}
+
+// The exception left by a dropped sender.
+ONESHOT_NOINLINE inline std::exception_ptr broken_promise() {
+    try {
+        throw_future_error(FutureErrc::BrokenPromise);
+    } catch (...) {
+        return std::current_exception();
+    }
+}
+
+} // namespace oneshot_detail
@@ -0,0 +1,255 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <exception>
+#include <future>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_senders)
+#include <execution>
+#define ONESHOT_EXEC_NS std::execution
+#elif __has_include(<stdexec/execution.hpp>) && !defined(ONESHOT_EXEC_NO_STDEXEC)
+#include <stdexec/execution.hpp>
+#define ONESHOT_EXEC_NS stdexec
+#endif
+
+#include "OneShotFuture.hpp"
+#include "OneShotWait.hpp"
+
+//
+// std::execution (P2300) adapters for OneShot.
+//
+//   oneshot_exec::as_sender(receiver)  exposes a OneShot<T>::Receiver as a typed
+//                                      sender: set_value(T) / set_error(exception_ptr),
+//                                      and set_stopped() for a broken promise
+//   oneshot_exec::sink(sender)         an execution receiver that fulfils a
+//                                      OneShot<T>::Sender with a pipeline's result
+//
+// Both follow the member-function protocol of the final P2300 wording
+// (connect/start/set_value/set_error/set_stopped/get_env), and complete
+// execution receivers through the tag CPOs. The tags come from the standard
+// library's <execution> when it ships senders (__cpp_lib_senders), else from
+// stdexec when <stdexec/execution.hpp> is on the include path (define
+// ONESHOT_EXEC_NO_STDEXEC to skip it). Without either, local stand-in tags are
+// defined: the adapters then only work with receivers and senders written
+// against oneshot_exec's own tags, not with any P2300 implementation.
+// The operation state embeds its own wait node, so neither direction blocks
+// a thread or allocates.
+//
+namespace oneshot_exec {
+
+#if defined(ONESHOT_EXEC_NS)
+using ONESHOT_EXEC_NS::sender_t;
+using ONESHOT_EXEC_NS::receiver_t;
+using ONESHOT_EXEC_NS::operation_state_t;
+using ONESHOT_EXEC_NS::set_value_t;
+using ONESHOT_EXEC_NS::set_error_t;
+using ONESHOT_EXEC_NS::set_stopped_t;
+using ONESHOT_EXEC_NS::completion_signatures;
+struct empty_env {};  // no queries
+#else
+struct sender_t {};
+struct receiver_t {};
+struct operation_state_t {};
+struct set_value_t {};
+struct set_error_t {};
+struct set_stopped_t {};
+template<typename... Sigs>
+struct completion_signatures {};
+struct empty_env {};
+#endif
+
+namespace detail {
+
+template<typename T>
+struct value_signature {
+    using type = set_value_t(T);
+};
+template<>
+struct value_signature<void> {
+    using type = set_value_t();
+};
+
+// Completes an execution receiver: through the library's CPOs when there is
+// one, else by calling the member directly.
+template<typename R, typename... Vs>
+void set_value(R&& r, Vs&&... vs) noexcept {
+#if defined(ONESHOT_EXEC_NS)
+    ONESHOT_EXEC_NS::set_value(std::forward<R>(r), std::forward<Vs>(vs)...);
+#else
+    std::forward<R>(r).set_value(std::forward<Vs>(vs)...);
+#endif
+}
+
+template<typename R>
+void set_error(R&& r, std::exception_ptr e) noexcept {
+#if defined(ONESHOT_EXEC_NS)
+    ONESHOT_EXEC_NS::set_error(std::forward<R>(r), std::move(e));
+#else
+    std::forward<R>(r).set_error(std::move(e));
+#endif
+}
+
+template<typename R>
+void set_stopped(R&& r) noexcept {
+#if defined(ONESHOT_EXEC_NS)
+    ONESHOT_EXEC_NS::set_stopped(std::forward<R>(r));
+#else
+    std::forward<R>(r).set_stopped();
+#endif
+}
+
+inline bool is_broken_promise(const std::exception_ptr& e) {
+    try {
+        std::rethrow_exception(e);
+    } catch (const std::future_error& fe) {
+        return fe.code() == std::make_error_code(std::future_errc::broken_promise);
+    } catch (...) {
+        return false;
+    }
+}
+
+} // namespace detail
+
+//
+// Operation state for a OneShot receiver (`Source`) connected to execution receiver R.
+//
+template<typename Source, typename R>
+class ReceiverOperation {
+    using T = typename Source::value_type;
+
+    Source source_;
+    R rcvr_;
+    oneshot_detail::WaitNode node_;
+
+    static void on_ready(oneshot_detail::WaitNode* n) noexcept {
+        static_cast<ReceiverOperation*>(n->ctx)->complete();
+    }
+
+    void complete() noexcept {
+        try {
+            deliver();
+        } catch (...) {
+            auto e = std::current_exception();
+            if (detail::is_broken_promise(e)) detail::set_stopped(std::move(rcvr_));
+            else detail::set_error(std::move(rcvr_), std::move(e));
+        }
+    }
+
+    template<typename U = T>
+    std::enable_if_t<!std::is_void<U>::value> deliver() {
+        U value = source_.get();
+        detail::set_value(std::move(rcvr_), std::move(value));
+    }
+    template<typename U = T>
+    std::enable_if_t<std::is_void<U>::value> deliver() {
+        source_.get();
+        detail::set_value(std::move(rcvr_));
+    }
+
+public:
+    using operation_state_concept = operation_state_t;
+
+    ReceiverOperation(Source src, R rcvr)
+        : source_(std::move(src)), rcvr_(std::move(rcvr)) {
+        node_.notify = &ReceiverOperation::on_ready;
+        node_.ctx = this;
+    }
+
+    ReceiverOperation(const ReceiverOperation&) = delete;
+    ReceiverOperation& operator=(const ReceiverOperation&) = delete;
+
+    ~ReceiverOperation() {
+        // an operation destroyed before completing must not leave its node behind;
+        // once completed, the result was consumed and the state released
+        if (auto& state = oneshot_detail::Access::state(source_)) state->remove_waiter(node_);
+    }
+
+    void start() noexcept {
+        auto& state = oneshot_detail::Access::state(source_);
+        if (!state) {
+            detail::set_error(std::move(rcvr_), std::make_exception_ptr(std::future_error(std::future_errc::no_state)));
+            return;
+        }
+        if (!state->add_waiter(node_)) complete();  // already ready: complete inline
+    }
+};
+
+//
+// A OneShot receiver (`Source`, e.g. OneShot<T>::Receiver) viewed as a
+// single-shot execution sender.
+//
+template<typename Source>
+class ReceiverSender {
+    using T = typename Source::value_type;
+
+    Source source_;
+
+public:
+    using sender_concept = sender_t;
+    using completion_signatures = oneshot_exec::completion_signatures<
+        typename detail::value_signature<T>::type, set_error_t(std::exception_ptr), set_stopped_t()>;
+
+    explicit ReceiverSender(Source r) : source_(std::move(r)) {}
+
+    template<typename R>
+    ReceiverOperation<Source, R> connect(R rcvr) && {
+        return ReceiverOperation<Source, R>(std::move(source_), std::move(rcvr));
+    }
+
+    empty_env get_env() const noexcept { return {}; }
+};
+
+template<typename Receiver>
+ReceiverSender<Receiver> as_sender(Receiver r) {
+    return ReceiverSender<Receiver>(std::move(r));
+}
+
+//
+// Execution receiver that completes a OneShot sender (`Sink`, e.g.
+// OneShot<T>::Sender). set_stopped() drops the sender, so the OneShot
+// receiver observes broken_promise.
+//
+template<typename Sink>
+class SenderSink {
+    Sink sender_;
+
+public:
+    using receiver_concept = receiver_t;
+
+    explicit SenderSink(Sink s) : sender_(std::move(s)) {}
+
+    template<typename... Vs>
+    void set_value(Vs&&... vs) && noexcept {
+        try {
+            sender_.set_value(std::forward<Vs>(vs)...);
+        } catch (...) {
+            sender_.set_exception(std::current_exception());
+        }
+    }
+
+    void set_error(std::exception_ptr e) && noexcept { sender_.set_exception(std::move(e)); }
+
+    template<typename E>
+    void set_error(E&& e) && noexcept {
+        sender_.set_exception(std::make_exception_ptr(std::forward<E>(e)));
+    }
+
+    void set_stopped() && noexcept { sender_ = {}; }
+
+    empty_env get_env() const noexcept { return {}; }
+};
+
+template<typename Sender>
+SenderSink<Sender> sink(Sender s) {
+    return SenderSink<Sender>(std::move(s));
+}
+
+} // namespace oneshot_exec
@@ -0,0 +1,222 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <ucontext.h>
+
+#include "OneShotWait.hpp"
+
+//
+// Minimal stackful fiber scheduler (ucontext based).
+//
+// run() drives every spawned fiber on the calling "carrier" thread. While a
+// fiber runs, the scheduler is installed as the thread's Parker, so a blocking
+// OneShot<T>::Receiver::get()/get_for() inside a fiber suspends only that fiber;
+// the Sender's completion re-enqueues it, from whichever thread completes it.
+// Outside of fibers, waits block the thread as before.
+//
+// spawn() may be called from any thread, including from fibers.
+class FiberScheduler : private oneshot_detail::Parker {
+    using Clock = std::chrono::steady_clock;
+
+    // Move-only type-erased fiber body
+    struct Task {
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+    template<typename F>
+    struct TaskOf : Task {
+        F fn;
+        explicit TaskOf(F&& f) : fn(std::move(f)) {}
+        void run() override { fn(); }
+    };
+
+    struct Fiber {
+        FiberScheduler* sched = nullptr;
+        ucontext_t ctx;
+        std::unique_ptr<char[]> stack;
+        std::unique_ptr<Task> fn;
+        bool finished = false;
+        std::atomic<bool> woken{false};       // one resumption per park: notify or timeout
+        std::optional<Clock::time_point> deadline;
+    };
+
+public:
+    explicit FiberScheduler(std::size_t stack_size = 128 * 1024) : stack_size_(stack_size) {}
+
+    FiberScheduler(const FiberScheduler&) = delete;
+    FiberScheduler& operator=(const FiberScheduler&) = delete;
+
+    template<typename F>
+    void spawn(F fn) {
+        auto f = std::make_unique<Fiber>();
+        f->sched = this;
+        f->fn.reset(new TaskOf<F>(std::move(fn)));
+        f->stack.reset(new char[stack_size_]);
+        getcontext(&f->ctx);
+        f->ctx.uc_stack.ss_sp = f->stack.get();
+        f->ctx.uc_stack.ss_size = stack_size_;
+        f->ctx.uc_link = nullptr;
+        makecontext(&f->ctx, &FiberScheduler::trampoline, 0);
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        ready_.push_back(f.get());
+        fibers_.push_back(std::move(f));
+        ++live_;
+        cv_.notify_one();
+    }
+
+    // Runs fibers on the calling thread until all of them have finished. The
+    // first exception escaping a fiber is rethrown once the others are done.
+    void run() {
+        for (;;) {
+            Fiber* f = next();
+            if (!f) break;
+            resume(f);
+            if (f->finished) retire(f);
+        }
+        if (auto e = std::exchange(error_, nullptr)) std::rethrow_exception(e);
+    }
+
+    // True on a thread currently executing a fiber.
+    static bool on_fiber() noexcept { return current_fiber() != nullptr; }
+
+    // Requeues the current fiber behind the other ready ones; no-op off a fiber.
+    static void yield() {
+        Fiber* f = current_fiber();
+        if (!f) return;
+        {
+            std::lock_guard<std::mutex> lock(f->sched->mtx_);
+            f->sched->ready_.push_back(f);
+        }
+        swapcontext(&f->ctx, &f->sched->carrier_);
+    }
+
+private:
+    std::size_t stack_size_;
+    ucontext_t carrier_;
+
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Fiber*> ready_;
+    std::vector<std::unique_ptr<Fiber>> fibers_;
+    std::vector<Fiber*> sleeping_;  // parked with a deadline
+    std::size_t live_ = 0;
+    std::exception_ptr error_;
+
+    static Fiber*& current_fiber() noexcept {
+        static thread_local Fiber* fiber = nullptr;
+        return fiber;
+    }
+
+    static void trampoline() {
+        Fiber* f = current_fiber();
+        try {
+            f->fn->run();
+        } catch (...) {
+            if (!f->sched->error_) f->sched->error_ = std::current_exception();
+        }
+        f->fn.reset();
+        f->finished = true;
+        setcontext(&f->sched->carrier_);
+    }
+
+    void resume(Fiber* f) {
+        Fiber* prev_fiber = std::exchange(current_fiber(), f);
+        oneshot_detail::Parker* self = this;
+        oneshot_detail::Parker* prev_parker = std::exchange(oneshot_detail::current_parker(), self);
+        swapcontext(&carrier_, &f->ctx);
+        oneshot_detail::current_parker() = prev_parker;
+        current_fiber() = prev_fiber;
+    }
+
+    void retire(Fiber* f) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        --live_;
+        for (auto it = fibers_.begin(); it != fibers_.end(); ++it) {
+            if (it->get() == f) {
+                fibers_.erase(it);
+                break;
+            }
+        }
+    }
+
+    // Next fiber to run, or nullptr once all fibers have finished.
+    Fiber* next() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        for (;;) {
+            expire_locked(Clock::now());
+            if (!ready_.empty()) {
+                Fiber* f = ready_.front();
+                ready_.pop_front();
+                return f;
+            }
+            if (live_ == 0) return nullptr;
+            auto earliest = Clock::time_point::max();
+            for (Fiber* s : sleeping_) earliest = std::min(earliest, *s->deadline);
+            if (earliest == Clock::time_point::max()) cv_.wait(lock);
+            else cv_.wait_until(lock, earliest);
+        }
+    }
+
+    void expire_locked(Clock::time_point now) {
+        for (auto it = sleeping_.begin(); it != sleeping_.end();) {
+            Fiber* f = *it;
+            if (*f->deadline <= now) {
+                if (!f->woken.exchange(true)) ready_.push_back(f);
+                it = sleeping_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    static void notify_fiber(oneshot_detail::WaitNode* node) noexcept {
+        Fiber* f = static_cast<Fiber*>(node->ctx);
+        if (f->woken.exchange(true)) return;  // already resumed by its deadline
+        FiberScheduler* s = f->sched;
+        std::lock_guard<std::mutex> lock(s->mtx_);
+        s->ready_.push_back(f);
+        s->cv_.notify_one();
+    }
+
+    void prepare(oneshot_detail::WaitNode& node) override {
+        Fiber* f = current_fiber();
+        f->woken.store(false);
+        node.notify = &FiberScheduler::notify_fiber;
+        node.ctx = f;
+    }
+
+    void park(oneshot_detail::WaitNode&, const Clock::time_point* deadline) override {
+        Fiber* f = current_fiber();
+        if (deadline) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            f->deadline = *deadline;
+            sleeping_.push_back(f);
+        }
+        swapcontext(&f->ctx, &carrier_);
+        if (deadline) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (auto it = sleeping_.begin(); it != sleeping_.end(); ++it) {
+                if (*it == f) {
+                    sleeping_.erase(it);
+                    break;
+                }
+            }
+            f->deadline.reset();
+        }
+    }
+};
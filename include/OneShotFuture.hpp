@@ -4,203 +4,426 @@
  */
 
 #pragma once
-#include <future>
 #include <memory>
 #include <atomic>
 #include <utility>
-#include <optional>
 #include <exception>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "OneShotValue.hpp"
+#include "OneShotWait.hpp"
+#include "OneShotObserver.hpp"
+#include "OneShotProbes.hpp"
+
+namespace oneshot_detail {
+
+// Shared body of OneShot<T>::complete_batch. `write(i)` claims slot i and
+// stores its payload, returning its core or nullptr when skipped; `core(i)`
+// returns slot i's core again for the publish and wake passes.
+template<typename Write, typename CoreAt>
+std::size_t complete_batch(std::size_t count, Write&& write, CoreAt&& core) {
+    constexpr std::size_t kChunk = 1024;  // bookkeeping lives on the stack
+    std::size_t completed = 0;
+    for (std::size_t base = 0; base < count; base += kChunk) {
+        std::size_t n = count - base < kChunk ? count - base : kChunk;
+        std::uint64_t written[kChunk / 64] = {};
+        std::uint64_t waiters[kChunk / 64] = {};
+
+        for (std::size_t i = 0; i < n; ++i) {
+            if (write(base + i)) written[i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!(written[i / 64] >> (i % 64) & 1)) continue;
+            ++completed;
+            if (core(base + i)->publish_relaxed()) waiters[i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+        for (std::size_t w = 0; w < kChunk / 64; ++w) {
+            if (!waiters[w]) continue;
+            for (std::size_t b = 0; b < 64; ++b) {
+                if (waiters[w] >> b & 1) core(base + w * 64 + b)->wake_waiters();
+            }
+        }
+    }
+    return completed;
+}
+
+// std::data / std::size without <iterator>
+template<typename C>
+auto data_of(C& c) -> decltype(c.data()) {
+    return c.data();
+}
+template<typename E, std::size_t N>
+E* data_of(E (&a)[N]) {
+    return a;
+}
+template<typename C>
+auto size_of(const C& c) -> decltype(c.size()) {
+    return c.size();
+}
+template<typename E, std::size_t N>
+std::size_t size_of(E (&)[N]) {
+    return N;
+}
+
+} // namespace oneshot_detail
 
 //
-// Generic template
+// Sender and Receiver share one allocation: a completion Core plus the payload
+// (none for OneShot<void>). Waits block the thread, or park the current fiber
+// when a scheduler installed a Parker on this thread (see OneShotFiber.hpp).
+// `Observer` is a compile-time hook policy (see OneShotObserver.hpp); the
+// default compiles to nothing.
 //
-template<typename T>
+// OneShot<T>: Sender::set_value(T), Receiver::get() -> T, get_for() -> std::optional<T>
+// OneShot<void>: Sender::set_value(), Receiver::get(), get_for() -> bool
+template<typename T, typename Observer = NullObserver>
 class OneShot {
-public:
-    class Sender {
-        std::shared_ptr<std::promise<T>> prom_;
-        std::shared_ptr<std::atomic<bool>> used_;
+    static constexpr bool is_void = std::is_void<T>::value;
 
-    public:
-        Sender() = default;
-        Sender(std::shared_ptr<std::promise<T>> p, std::shared_ptr<std::atomic<bool>> u)
-            : prom_(std::move(p)), used_(std::move(u)) {}
-
-        Sender(Sender&&) noexcept = default;
-        Sender& operator=(Sender&&) noexcept = default;
-        Sender(const Sender&) = delete;
-        Sender& operator=(const Sender&) = delete;
+    struct State;
 
-        ~Sender() {
-            // if promise not fulfilled, mark broken_promise
-            if (prom_ && !used_->load()) {
-                try {
-                    prom_->set_exception(
-                        std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
-                } catch (...) {
-                    // ignore double-set exceptions
-                }
-            }
-        }
-
-        bool set_value(T value) {
-            if (!prom_) return false;
-            bool expected = false;
-            if (!used_->compare_exchange_strong(expected, true)) return false;
-            prom_->set_value(std::move(value));
-            return true;
-        }
-
-        bool set_exception(std::exception_ptr e) {
-            if (!prom_) return false;
-            bool expected = false;
-            if (!used_->compare_exchange_strong(expected, true)) return false;
-            prom_->set_exception(std::move(e));
-            return true;
-        }
-
-        explicit operator bool() const noexcept { return (bool)prom_; }
+    // forward(): where a state's result goes once published. Allocated by
+    // forward() when it has to wait, so other states do not carry it.
+    struct Forward {
+        oneshot_detail::WaitNode node;
+        std::shared_ptr<State> to;
     };
 
-    class Receiver {
-        std::future<T> fut_;
+    struct State : oneshot_detail::Core, oneshot_detail::Payload<T>, Observer::Data {
+        std::exception_ptr error;
+        std::atomic<Forward*> forward{nullptr};  // published before its node is linked
 
-    public:
-        Receiver() = default;
-        explicit Receiver(std::future<T>&& f) : fut_(std::move(f)) {}
-
-        Receiver(Receiver&&) noexcept = default;
-        Receiver& operator=(Receiver&&) noexcept = default;
-        Receiver(const Receiver&) = delete;
-        Receiver& operator=(const Receiver&) = delete;
-
-        T get() { return fut_.get(); }
-
-        bool ready() const {
-            using namespace std::chrono_literals;
-            return fut_.wait_for(0s) == std::future_status::ready;
-        }
+        ~State() { delete forward.load(std::memory_order_relaxed); }
+    };
 
-        template<typename Rep, typename Period>
-        bool wait_for(const std::chrono::duration<Rep, Period>& dur) const {
-            return fut_.wait_for(dur) == std::future_status::ready;
+    // Skips states whose own result is still waiting to be forwarded, so a
+    // chain of proxies delivers straight to its far end.
+    static std::shared_ptr<State> collapse(std::shared_ptr<State> to) {
+        for (;;) {
+            Forward* f = to->forward.load(std::memory_order_acquire);
+            if (!f || !to->remove_waiter(f->node)) return to;
+            to = std::move(f->to);
         }
+    }
 
-        // Returns std::optional<T> with timeout
-        template<typename Rep, typename Period>
-        std::optional<T> get_for(const std::chrono::duration<Rep, Period>& dur) {
-            if (fut_.wait_for(dur) == std::future_status::ready) {
-                return fut_.get();
+    // Writes the value into a claimed state. The claim cannot be undone, so a
+    // throwing constructor becomes the state's result instead of escaping.
+    template<typename... V>
+    static void store_value(State& st, V&&... v) noexcept {
+        if constexpr (!is_void) {
+            try {
+                st.value.emplace(std::forward<V>(v)...);
+            } catch (...) {
+                st.error = std::current_exception();
             }
-            return std::nullopt;
         }
+    }
 
-        explicit operator bool() const noexcept { return fut_.valid(); }
-    };
-
-    static std::pair<Sender, Receiver> make() {
-        auto prom = std::make_shared<std::promise<T>>();
-        auto used = std::make_shared<std::atomic<bool>>(false);
-        Sender s{prom, used};
-        Receiver r{prom->get_future()};
-        return {std::move(s), std::move(r)};
+    static void deliver(State& from, std::shared_ptr<State> to) {
+        to = collapse(std::move(to));
+        if (!to->claim()) {
+            from.drop_receiver();  // nobody will take it
+            return;
+        }
+        if (from.error) {
+            to->error = from.error;
+        } else {
+            if constexpr (!is_void) store_value(*to, std::move(*from.value));
+        }
+        from.mark_taken();
+        Observer::on_set(*to);
+        ONESHOT_PROBE2(oneshot, set, to.get(), to->error != nullptr);
+        to->publish();
     }
-};
 
+    static void on_forward(oneshot_detail::WaitNode* n) noexcept {
+        State* from = static_cast<State*>(n->ctx);
+        deliver(*from, std::move(from->forward.load(std::memory_order_relaxed)->to));
+    }
 
-//
-// void specialization
-//
-template<>
-class OneShot<void> {
 public:
-    class Sender {
-        std::shared_ptr<std::promise<void>> prom_;
-        std::shared_ptr<std::atomic<bool>> used_;
+    class Receiver;
+
+    class Sender : public oneshot_detail::SetValue<Sender, T>,
+                   public oneshot_detail::TrySetValue<Sender, T>,
+                   public oneshot_detail::SetValueAndWait<Sender, T> {
+        friend struct oneshot_detail::Access;
+        friend struct oneshot_detail::SetValue<Sender, T>;
+        friend struct oneshot_detail::TrySetValue<Sender, T>;
+        friend struct oneshot_detail::SetValueAndWait<Sender, T>;
+        std::shared_ptr<State> state_;
 
     public:
+        using value_type = T;
+
         Sender() = default;
-        Sender(std::shared_ptr<std::promise<void>> p, std::shared_ptr<std::atomic<bool>> u)
-            : prom_(std::move(p)), used_(std::move(u)) {}
+        explicit Sender(std::shared_ptr<State> s) : state_(std::move(s)) {}
 
         Sender(Sender&&) noexcept = default;
-        Sender& operator=(Sender&&) noexcept = default;
+        Sender& operator=(Sender&& other) noexcept {
+            if (this != &other) {
+                abandon();
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
         Sender(const Sender&) = delete;
         Sender& operator=(const Sender&) = delete;
 
-        ~Sender() {
-            if (prom_ && !used_->load()) {
-                try {
-                    prom_->set_exception(
-                        std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
-                } catch (...) {
-                }
-            }
-        }
+        ~Sender() { abandon(); }
+
+        // bool set_value(T) / bool set_value(): see oneshot_detail::SetValue
+        //
+        // std::optional<T> try_set_value(T&&) (OneShot<T> only): like set_value,
+        // but hands the value back instead of discarding it when nobody will take
+        // it: the Receiver was dropped unconsumed, the sender is empty or already
+        // completed. Returns std::nullopt once the value was delivered. A Receiver
+        // dropped concurrently, or one that was forwarded, may still get (and
+        // discard) it. Handing a value back to a dropped Receiver completes the
+        // sender, so destroying it afterwards does not create a broken_promise.
+        //
+        // RendezvousResult set_value_and_wait(T) / set_value_and_wait_for(T, d):
+        // sets the value, then waits (parking a fiber) until the Receiver took
+        // it with get()/get_for(), or was dropped; see oneshot_detail::SetValueAndWait.
+        // A forwarded value counts as taken once it reaches the next state.
+        //
+        // A value whose move into the state throws completes the sender with
+        // that exception instead, so the Receiver never waits forever.
 
-        bool set_value() {
-            if (!prom_) return false;
-            bool expected = false;
-            if (!used_->compare_exchange_strong(expected, true)) return false;
-            prom_->set_value();
+        bool set_exception(std::exception_ptr e) {
+            if (!state_ || !state_->claim()) return false;
+            state_->error = std::move(e);
+            Observer::on_set(*state_);
+            ONESHOT_PROBE2(oneshot, set, state_.get(), 1);
+            state_->publish();
             return true;
         }
 
-        bool set_exception(std::exception_ptr e) {
-            if (!prom_) return false;
-            bool expected = false;
-            if (!used_->compare_exchange_strong(expected, true)) return false;
-            prom_->set_exception(std::move(e));
+        // True once the Receiver was dropped without taking a result, e.g. as a
+        // straggler of oneshot_select::when_n: work towards a value can stop.
+        bool cancelled() const noexcept { return state_ && state_->receiver_gone(); }
+
+        // Completes this sender with whatever `r` eventually yields; see OneShot::forward.
+        void set_from(Receiver&& r) { forward(std::move(r), std::move(*this)); }
+
+        explicit operator bool() const noexcept { return (bool)state_; }
+
+    private:
+        template<typename... V>
+        bool complete_value(V&&... v) {
+            if (!state_ || !state_->claim()) return false;
+            store_value(*state_, std::forward<V>(v)...);
+            Observer::on_set(*state_);
+            ONESHOT_PROBE2(oneshot, set, state_.get(), state_->error != nullptr);
+            state_->publish();
             return true;
         }
 
-        explicit operator bool() const noexcept { return (bool)prom_; }
+        template<typename... V>
+        RendezvousResult complete_and_wait(const std::chrono::steady_clock::time_point* deadline, V&&... v) {
+            if (!state_ || !state_->claim_rendezvous()) return RendezvousResult::Rejected;
+            store_value(*state_, std::forward<V>(v)...);
+            Observer::on_set(*state_);
+            ONESHOT_PROBE2(oneshot, set, state_.get(), state_->error != nullptr);
+            state_->publish();
+            if (!state_->wait_taken(deadline)) return RendezvousResult::TimedOut;
+            return state_->taken() ? RendezvousResult::Consumed : RendezvousResult::ReceiverGone;
+        }
+
+        template<typename V>
+        std::optional<V> try_complete_value(V&& value) {
+            if (!state_) return std::optional<V>(std::move(value));
+            if (state_->receiver_gone()) {
+                state_->claim();  // completes the sender: dropping it later breaks nothing
+                return std::optional<V>(std::move(value));
+            }
+            if (!state_->claim()) return std::optional<V>(std::move(value));
+            store_value(*state_, std::move(value));
+            Observer::on_set(*state_);
+            ONESHOT_PROBE2(oneshot, set, state_.get(), state_->error != nullptr);
+            state_->publish();
+            return std::nullopt;
+        }
+
+        void abandon() noexcept {
+            // if promise not fulfilled, mark broken_promise
+            if (state_ && state_->claim()) {
+                state_->error = oneshot_detail::broken_promise();
+                Observer::on_broken(*state_);
+                ONESHOT_PROBE1(oneshot, broken, state_.get());
+                state_->publish();
+            }
+        }
     };
 
     class Receiver {
-        std::future<void> fut_;
+        friend struct oneshot_detail::Access;
+        std::shared_ptr<State> state_;
 
     public:
+        using value_type = T;
+
         Receiver() = default;
-        explicit Receiver(std::future<void>&& f) : fut_(std::move(f)) {}
+        explicit Receiver(std::shared_ptr<State> s) : state_(std::move(s)) {}
 
         Receiver(Receiver&&) noexcept = default;
-        Receiver& operator=(Receiver&&) noexcept = default;
+        Receiver& operator=(Receiver&& other) noexcept {
+            if (this != &other) {
+                release();
+                state_ = std::move(other.state_);
+            }
+            return *this;
+        }
         Receiver(const Receiver&) = delete;
         Receiver& operator=(const Receiver&) = delete;
 
-        void get() { fut_.get(); }
-
-        bool ready() const {
-            using namespace std::chrono_literals;
-            return fut_.wait_for(0s) == std::future_status::ready;
+        ~Receiver() { release(); }
+
+        // Like std::future::get(), consumes the result and invalidates the receiver.
+        T get() {
+            if (!state_) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+            std::uint64_t t0 = Observer::now();
+            Observer::on_wait(*state_);
+            ONESHOT_PROBE1(oneshot, block, state_.get());
+            state_->wait();
+            ONESHOT_PROBE2(oneshot, wake, state_.get(), 1);
+            Observer::on_wake(*state_, t0);
+            return take();
         }
 
+        bool ready() const { return state_ && state_->is_ready(); }
+
         template<typename Rep, typename Period>
         bool wait_for(const std::chrono::duration<Rep, Period>& dur) const {
-            return fut_.wait_for(dur) == std::future_status::ready;
+            if (!state_) return false;
+            return state_->wait_until(std::chrono::steady_clock::now() +
+                                      std::chrono::duration_cast<std::chrono::steady_clock::duration>(dur));
         }
 
-        // returns true if completed within timeout
+        // std::optional<T> (OneShot<T>) or bool (OneShot<void>); empty on timeout
         template<typename Rep, typename Period>
-        bool get_for(const std::chrono::duration<Rep, Period>& dur) {
-            if (fut_.wait_for(dur) == std::future_status::ready) {
-                fut_.get();
+        oneshot_detail::TimedResult<T> get_for(const std::chrono::duration<Rep, Period>& dur) {
+            if (!timed_wait(dur)) return {};
+            if constexpr (is_void) {
+                take();
                 return true;
+            } else {
+                return take();
             }
-            return false;
         }
 
-        explicit operator bool() const noexcept { return fut_.valid(); }
+        explicit operator bool() const noexcept { return (bool)state_; }
+
+    private:
+        // Dropped without taking the result: let try_set_value hand it back.
+        void release() noexcept {
+            if (state_) state_->drop_receiver();
+        }
+
+        template<typename Rep, typename Period>
+        bool timed_wait(const std::chrono::duration<Rep, Period>& dur) {
+            if (!state_) return false;
+            std::uint64_t t0 = Observer::now();
+            Observer::on_wait(*state_);
+            ONESHOT_PROBE1(oneshot, block, state_.get());
+            bool ready = state_->wait_until(std::chrono::steady_clock::now() +
+                                            std::chrono::duration_cast<std::chrono::steady_clock::duration>(dur));
+            ONESHOT_PROBE2(oneshot, wake, state_.get(), ready);
+            if (ready) Observer::on_wake(*state_, t0);
+            else Observer::on_timeout(*state_, t0);
+            return ready;
+        }
+
+        T take() {
+            auto s = std::move(state_);
+            s->mark_taken();
+            Observer::on_consume(*s);
+            if (s->error) std::rethrow_exception(s->error);
+            if constexpr (!is_void) return std::move(*s->value);
+        }
     };
 
     static std::pair<Sender, Receiver> make() {
-        auto prom = std::make_shared<std::promise<void>>();
-        auto used = std::make_shared<std::atomic<bool>>(false);
-        Sender s{prom, used};
-        Receiver r{prom->get_future()};
+        auto state = std::make_shared<State>();
+        Observer::on_create(*state);
+        Sender s{state};
+        Receiver r{std::move(state)};
         return {std::move(s), std::move(r)};
     }
-};
 
+    // Links `from` into `to` without a thread: when `from` completes, its value
+    // or exception (including broken_promise) completes `to` directly, on the
+    // completing thread. Both handles are consumed. Proxies of proxies collapse,
+    // so a chain costs one delivery however many hops it has. Forwarding a
+    // one-shot into itself, directly or around a chain, could never complete:
+    // both handles are dropped and nothing is delivered.
+    static void forward(Receiver&& from, Sender&& to) {
+        auto src = std::move(oneshot_detail::Access::state(from));
+        if (!src) oneshot_detail::throw_future_error(oneshot_detail::FutureErrc::NoState);
+        auto dst = std::move(oneshot_detail::Access::state(to));
+        if (!dst) {
+            src->drop_receiver();
+            return;
+        }
+        dst = collapse(std::move(dst));
+        if (dst == src) {
+            src->drop_receiver();
+            return;
+        }
+        if (src->is_ready()) {
+            deliver(*src, std::move(dst));
+            return;
+        }
+        auto* f = new Forward;
+        f->to = std::move(dst);
+        f->node.notify = &on_forward;
+        f->node.ctx = src.get();
+        src->forward.store(f, std::memory_order_release);
+        if (!src->add_waiter(f->node)) on_forward(&f->node);
+    }
+
+    // Completes senders[i] with values[i] for every i < count: all payloads are
+    // written first, published behind a single release fence, and only states
+    // with a blocked or registered waiter are woken, in one pass at the end.
+    // Empty or already completed senders are skipped (their value is left as is).
+    // Returns the number of senders completed. OneShot<void> takes senders only.
+    template<typename U = T, std::enable_if_t<!std::is_void<U>::value, int> = 0>
+    static std::size_t complete_batch(Sender* senders, U* values, std::size_t count) {
+        return complete_batch_impl(senders, count,
+                                   [&](State& st, std::size_t i) { store_value(st, std::move(values[i])); });
+    }
+
+    template<typename U = T, std::enable_if_t<std::is_void<U>::value, int> = 0>
+    static std::size_t complete_batch(Sender* senders, std::size_t count) {
+        return complete_batch_impl(senders, count, [](State&, std::size_t) {});
+    }
+
+    // Same for contiguous ranges (std::vector, std::array, ...).
+    template<typename Senders, typename Values, typename U = T, std::enable_if_t<!std::is_void<U>::value, int> = 0>
+    static std::size_t complete_batch(Senders& senders, Values& values) {
+        std::size_t ns = oneshot_detail::size_of(senders), nv = oneshot_detail::size_of(values);
+        return complete_batch(oneshot_detail::data_of(senders), oneshot_detail::data_of(values), ns < nv ? ns : nv);
+    }
+
+    template<typename Senders, typename U = T, std::enable_if_t<std::is_void<U>::value, int> = 0>
+    static std::size_t complete_batch(Senders& senders) {
+        return complete_batch(oneshot_detail::data_of(senders), oneshot_detail::size_of(senders));
+    }
+
+private:
+    template<typename Write>
+    static std::size_t complete_batch_impl(Sender* senders, std::size_t count, Write&& write) {
+        return oneshot_detail::complete_batch(count, [&](std::size_t i) -> oneshot_detail::Core* {
+            auto& st = oneshot_detail::Access::state(senders[i]);
+            if (!st || !st->claim()) return nullptr;
+            write(*st, i);
+            Observer::on_set(*st);
+            ONESHOT_PROBE2(oneshot, set, st.get(), st->error != nullptr);
+            return st.get();
+        }, [&](std::size_t i) -> oneshot_detail::Core* { return oneshot_detail::Access::state(senders[i]).get(); });
+    }
+};
@@ -0,0 +1,244 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+//
+// Compile-time observer policies for OneShot<T, Observer> and
+// OneShotChannel<T, Observer>.
+//
+// An observer is a type with static hooks and a per-state `Data` struct that
+// is embedded (as an empty base when empty) in every shared state. The
+// default, NullObserver, has empty inline hooks and empty Data, so the
+// unobserved types compile to exactly what they were before.
+//
+//   on_create(d)              state made
+//   on_set(d)                 value or exception published
+//   on_broken(d)              sender dropped without a result
+//   on_wait(d)                a receiver is about to wait in get()/get_for()
+//   on_wake(d, wait_begin)    a receiver's wait returned with the result ready
+//   on_timeout(d, wait_begin) a receiver's timed wait expired
+//   on_consume(d)             a receiver took the result
+//   on_reset(d)               a channel was re-armed
+//   now()                     timestamp passed back as `wait_begin`
+//
+struct NullObserver {
+    struct Data {};
+
+    static std::uint64_t now() noexcept { return 0; }
+    static void on_create(Data&) noexcept {}
+    static void on_set(Data&) noexcept {}
+    static void on_broken(Data&) noexcept {}
+    static void on_wait(Data&) noexcept {}
+    static void on_wake(Data&, std::uint64_t) noexcept {}
+    static void on_timeout(Data&, std::uint64_t) noexcept {}
+    static void on_consume(Data&) noexcept {}
+    static void on_reset(Data&) noexcept {}
+};
+
+namespace oneshot_obs {
+
+inline const char*& current_label() noexcept {
+    static thread_local const char* label = nullptr;
+    return label;
+}
+
+//
+// Labels the one-shots made on this thread while in scope, for observers that
+// record a label (TraceObserver, RegistryObserver). The string must outlive
+// every state made under it; literals are typical.
+//
+class ScopedLabel {
+    const char* prev_;
+
+public:
+    explicit ScopedLabel(const char* label) noexcept : prev_(current_label()) { current_label() = label; }
+    ~ScopedLabel() { current_label() = prev_; }
+    ScopedLabel(const ScopedLabel&) = delete;
+    ScopedLabel& operator=(const ScopedLabel&) = delete;
+};
+
+//
+// Cheap monotonic timestamps: the TSC on x86, steady_clock nanoseconds elsewhere.
+//
+struct Tsc {
+    static std::uint64_t now() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();  // avoids parsing <x86intrin.h> in every includer
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Ticks per nanosecond, measured against steady_clock since program start.
+    // Only a call within the first 10ms of the program spins, until then.
+    static double ticks_per_ns() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+        std::chrono::nanoseconds ns;
+        std::uint64_t tsc;
+        do {
+            tsc = now();
+            ns = std::chrono::steady_clock::now() - start.ns;
+        } while (ns < std::chrono::milliseconds(10));
+        return static_cast<double>(tsc - start.tsc) / static_cast<double>(ns.count());
+#else
+        return 1.0;
+#endif
+    }
+
+private:
+    struct Baseline {
+        std::uint64_t tsc;
+        std::chrono::steady_clock::time_point ns;
+    };
+    // taken during static initialization, never on a recording path
+    static inline const Baseline start{now(), std::chrono::steady_clock::now()};
+};
+
+//
+// Lock-free log-linear (HDR-style) histogram: values are bucketed by power of
+// two with 16 linear sub-buckets each (~6% relative error). record() is one
+// relaxed fetch_add, so it is safe from any thread.
+//
+class Histogram {
+public:
+    static constexpr int kSubBits = 4;
+    static constexpr std::size_t kSub = std::size_t(1) << kSubBits;
+    static constexpr std::size_t kBuckets = (64 - kSubBits + 1) * kSub;
+
+    struct Snapshot {
+        std::uint64_t count = 0;
+        std::uint64_t counts[kBuckets] = {};
+
+        // Upper bound of the bucket holding quantile q in [0, 1], in recorded units.
+        std::uint64_t percentile(double q) const noexcept {
+            if (count == 0) return 0;
+            auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; ++i) {
+                seen += counts[i];
+                if (seen >= rank) return upper_bound(i);
+            }
+            return upper_bound(kBuckets - 1);
+        }
+    };
+
+    void record(std::uint64_t value) noexcept { counts_[index(value)].fetch_add(1, std::memory_order_relaxed); }
+
+    Snapshot snapshot() const noexcept {
+        Snapshot s;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            s.counts[i] = counts_[i].load(std::memory_order_relaxed);
+            s.count += s.counts[i];
+        }
+        return s;
+    }
+
+    void clear() noexcept {
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+    }
+
+    static std::size_t index(std::uint64_t v) noexcept {
+        if (v < kSub) return static_cast<std::size_t>(v);
+        int msb = 63;
+        while (!(v >> msb)) --msb;
+        int shift = msb - kSubBits;
+        auto sub = static_cast<std::size_t>((v >> shift) & (kSub - 1));
+        return static_cast<std::size_t>(shift + 1) * kSub + sub;
+    }
+
+    static std::uint64_t upper_bound(std::size_t i) noexcept {
+        if (i < kSub) return i;
+        std::size_t shift = i / kSub - 1;
+        std::uint64_t base = (std::uint64_t(kSub) | (i % kSub)) << shift;
+        return base + ((std::uint64_t(1) << shift) - 1);
+    }
+
+private:
+    std::atomic<std::uint64_t> counts_[kBuckets] = {};
+};
+
+} // namespace oneshot_obs
+
+//
+// Built-in recorder: set-to-wake latency (how long a result sat before its
+// receiver observed it) and wait duration (how long receivers were parked in
+// get()/get_for()), in TSC ticks. `Tag` separates independent recorders.
+//
+// The histograms are constant-initialized statics, so the hooks never run a
+// guarded first-use initialization.
+//
+template<typename Tag = void>
+struct LatencyObserver {
+    struct Data {
+        // Relaxed: a channel's reset() rewrites it while receivers of the
+        // previous generation may still be reading it in on_wake.
+        std::atomic<std::uint64_t> set_at{0};
+    };
+
+    struct Snapshot {
+        oneshot_obs::Histogram::Snapshot set_to_wake;
+        oneshot_obs::Histogram::Snapshot wait;
+        std::uint64_t timeouts = 0;
+        std::uint64_t broken = 0;
+        double ticks_per_ns = 1.0;  // divide percentile() results by this for nanoseconds
+    };
+
+    static std::uint64_t now() noexcept { return oneshot_obs::Tsc::now(); }
+
+    static void on_create(Data& d) noexcept { d.set_at.store(0, std::memory_order_relaxed); }
+    static void on_set(Data& d) noexcept { d.set_at.store(now(), std::memory_order_relaxed); }
+    static void on_broken(Data&) noexcept { broken_.fetch_add(1, std::memory_order_relaxed); }
+    static void on_wait(Data&) noexcept {}
+
+    static void on_wake(Data& d, std::uint64_t wait_begin) noexcept {
+        std::uint64_t t = now();
+        std::uint64_t set_at = d.set_at.load(std::memory_order_relaxed);
+        if (set_at) set_to_wake_.record(t > set_at ? t - set_at : 0);
+        wait_.record(t > wait_begin ? t - wait_begin : 0);
+    }
+
+    static void on_timeout(Data&, std::uint64_t wait_begin) noexcept {
+        std::uint64_t t = now();
+        wait_.record(t > wait_begin ? t - wait_begin : 0);
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void on_consume(Data&) noexcept {}
+    static void on_reset(Data& d) noexcept { d.set_at.store(0, std::memory_order_relaxed); }
+
+    static Snapshot snapshot() noexcept {
+        Snapshot s;
+        s.set_to_wake = set_to_wake_.snapshot();
+        s.wait = wait_.snapshot();
+        s.timeouts = timeouts_.load(std::memory_order_relaxed);
+        s.broken = broken_.load(std::memory_order_relaxed);
+        s.ticks_per_ns = oneshot_obs::Tsc::ticks_per_ns();
+        return s;
+    }
+
+    static void clear() noexcept {
+        set_to_wake_.clear();
+        wait_.clear();
+        timeouts_.store(0, std::memory_order_relaxed);
+        broken_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static inline oneshot_obs::Histogram set_to_wake_;
+    static inline oneshot_obs::Histogram wait_;
+    static inline std::atomic<std::uint64_t> timeouts_{0};
+    static inline std::atomic<std::uint64_t> broken_{0};
+};
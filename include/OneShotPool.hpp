@@ -0,0 +1,192 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+//
+// Round-trip payload pool: the producer acquires buffers from its pool, sends
+// them through a OneShot or a Channel as Pooled<T> handles, and the
+// consumer's handle puts the buffer back when it is destroyed. Buffers are
+// allocated and freed on the producer's side only, and once the pool is warm
+// a handoff allocates nothing for the payload.
+//
+//   oneshot_pool::Pool<std::vector<char>> pool;
+//   auto [tx, rx] = OneShot<oneshot_pool::Pooled<std::vector<char>>>::make();
+//
+//   auto buf = pool.acquire();          // reused buffer, contents as left by the last user
+//   fill(*buf);
+//   tx.set_value(std::move(buf));
+//   ...
+//   consume(*rx.get());                 // the handle returns the buffer when it goes away
+//
+// Pooled<T> is move-only, so it travels through OneShot and Channel
+// (BoundedChannel.hpp), not through OneShotChannel, whose get() copies.
+//
+// Returns go onto a lock-free stack (one CAS, from any thread); acquire() takes
+// the whole stack in one exchange when its private free list runs dry. acquire()
+// and stats() may be called from the producer's thread only: a Pool has one
+// owner, like a Sender. Handles keep the pool's storage alive, so they may
+// outlive the Pool; idle buffers are freed once both are gone.
+//
+namespace oneshot_pool {
+
+struct PoolStats {
+    std::uint64_t created = 0;      // buffers ever constructed
+    std::uint64_t acquired = 0;     // acquire() calls
+    std::uint64_t reused = 0;       // ... served by a returned buffer
+    std::uint64_t returned = 0;     // handles destroyed or reset
+    std::uint64_t outstanding = 0;  // acquired, not returned yet
+    std::uint64_t idle = 0;         // in the pool, ready for acquire()
+};
+
+namespace detail {
+
+template<typename T>
+struct Node {
+    T value;
+    Node* next = nullptr;
+
+    template<typename... Args>
+    explicit Node(Args&&... args) : value(std::forward<Args>(args)...) {}
+};
+
+template<typename T>
+struct Storage {
+    std::atomic<Node<T>*> returned{nullptr};  // pushed by handles, drained by acquire()
+    std::atomic<std::uint64_t> returns{0};
+    Node<T>* free = nullptr;                  // producer only
+
+    ~Storage() {
+        destroy(free);
+        destroy(returned.load(std::memory_order_acquire));
+    }
+
+    void give_back(Node<T>* n) noexcept {
+        returns.fetch_add(1, std::memory_order_relaxed);  // first, so that idle never underflows
+        Node<T>* head = returned.load(std::memory_order_relaxed);
+        do {
+            n->next = head;
+        } while (!returned.compare_exchange_weak(head, n, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Pops a returned buffer, or returns nullptr if there is none.
+    Node<T>* take() noexcept {
+        if (!free) free = returned.exchange(nullptr, std::memory_order_acquire);
+        Node<T>* n = free;
+        if (n) free = n->next;
+        return n;
+    }
+
+private:
+    static void destroy(Node<T>* n) noexcept {
+        while (n) delete std::exchange(n, n->next);
+    }
+};
+
+} // namespace detail
+
+template<typename T>
+class Pool;
+
+// Unique handle to a pooled buffer; destroying it puts the buffer back.
+template<typename T>
+class Pooled {
+    friend class Pool<T>;
+
+    std::shared_ptr<detail::Storage<T>> storage_;
+    detail::Node<T>* node_ = nullptr;
+
+    Pooled(std::shared_ptr<detail::Storage<T>> s, detail::Node<T>* n) noexcept : storage_(std::move(s)), node_(n) {}
+
+public:
+    Pooled() = default;
+    Pooled(Pooled&& other) noexcept
+        : storage_(std::move(other.storage_)), node_(std::exchange(other.node_, nullptr)) {}
+    Pooled& operator=(Pooled&& other) noexcept {
+        if (this != &other) {
+            reset();
+            storage_ = std::move(other.storage_);
+            node_ = std::exchange(other.node_, nullptr);
+        }
+        return *this;
+    }
+    Pooled(const Pooled&) = delete;
+    Pooled& operator=(const Pooled&) = delete;
+
+    ~Pooled() { reset(); }
+
+    // Returns the buffer to its pool now; the handle becomes empty.
+    void reset() noexcept {
+        if (!node_) return;
+        storage_->give_back(std::exchange(node_, nullptr));
+        storage_.reset();
+    }
+
+    T& operator*() const noexcept { return node_->value; }
+    T* operator->() const noexcept { return &node_->value; }
+    T* get() const noexcept { return node_ ? &node_->value : nullptr; }
+
+    explicit operator bool() const noexcept { return node_ != nullptr; }
+};
+
+template<typename T>
+class Pool {
+    std::shared_ptr<detail::Storage<T>> storage_ = std::make_shared<detail::Storage<T>>();
+    std::uint64_t created_ = 0;
+    std::uint64_t acquired_ = 0;
+    std::uint64_t reused_ = 0;
+
+public:
+    Pool() = default;
+    // a moved-from Pool may only be destroyed or assigned to
+    Pool(Pool&&) noexcept = default;
+    Pool& operator=(Pool&&) noexcept = default;
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    // A returned buffer as its last user left it, or a new one built from
+    // `args` when none has come back.
+    template<typename... Args>
+    Pooled<T> acquire(Args&&... args) {
+        ++acquired_;
+        detail::Node<T>* n = storage_->take();
+        if (n) {
+            ++reused_;
+        } else {
+            n = new detail::Node<T>(std::forward<Args>(args)...);
+            ++created_;
+        }
+        return Pooled<T>(storage_, n);
+    }
+
+    // Builds `n` buffers from `args` up front so that the first acquires reuse.
+    template<typename... Args>
+    void reserve(std::size_t n, const Args&... args) {
+        while (n--) {
+            auto* node = new detail::Node<T>(args...);
+            ++created_;
+            node->next = storage_->free;
+            storage_->free = node;
+        }
+    }
+
+    PoolStats stats() const noexcept {
+        PoolStats s;
+        s.created = created_;
+        s.acquired = acquired_;
+        s.reused = reused_;
+        s.returned = storage_->returns.load(std::memory_order_relaxed);
+        s.outstanding = acquired_ - s.returned;
+        s.idle = created_ - s.outstanding;
+        return s;
+    }
+};
+
+} // namespace oneshot_pool
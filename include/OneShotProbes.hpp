@@ -0,0 +1,41 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+
+//
+// USDT (SystemTap SDT) probes on the one-shot hot paths, for bpftrace, perf and
+// SystemTap on live processes. Compiled in whenever <sys/sdt.h> is available
+// (define ONESHOT_DISABLE_PROBES to opt out); an unattached probe is a single
+// nop plus a note section entry. Without <sys/sdt.h> the macros expand to
+// nothing and their arguments are not evaluated.
+//
+// Providers are `oneshot` (OneShot<T>) and `oneshot_channel` (OneShotChannel<T>).
+// The first argument is always the address of the shared state, which
+// correlates the events of one handoff:
+//
+//   set(state, is_exception)   a value or exception was accepted
+//   broken(state)              a sender was dropped without a result
+//   block(state)               a receiver entered get() / get_for()
+//   wake(state, ready)         ...and returned; ready is 0 on timeout
+//   reset(state)               a channel was re-armed (oneshot_channel only)
+//
+//   bpftrace -e 'usdt:./app:oneshot:set { @t[arg0] = nsecs; }
+//                usdt:./app:oneshot:wake /@t[arg0]/ { @lat = hist(nsecs - @t[arg0]); delete(@t[arg0]); }'
+//
+#if !defined(ONESHOT_DISABLE_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ONESHOT_HAVE_PROBES 1
+#endif
+#endif
+
+#if defined(ONESHOT_HAVE_PROBES)
+#define ONESHOT_PROBE1(provider, name, a) DTRACE_PROBE1(provider, name, a)
+#define ONESHOT_PROBE2(provider, name, a, b) DTRACE_PROBE2(provider, name, a, b)
+#else
+#define ONESHOT_PROBE1(provider, name, a) ((void)0)
+#define ONESHOT_PROBE2(provider, name, a, b) ((void)0)
+#endif
@@ -0,0 +1,263 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "OneShotObserver.hpp"
+
+//
+// Live registry of pending one-shots, for finding what a hung process waits on.
+//
+// With RegistryObserver as the observer, every OneShot / OneShotChannel state
+// is linked into an intrusive list owned by the thread that made (or re-armed)
+// it, from make() until it is set, broken or destroyed. Linking is a TSC read
+// and a few stores under an uncontended per-thread spinlock; nothing is
+// allocated. oneshot_registry::snapshot() walks all lists and reports the
+// oldest pending states, receivers blocked longer than a threshold, and
+// outstanding count and memory gauges.
+//
+//   oneshot_obs::ScopedLabel label("db_query");
+//   auto [s, r] = OneShot<Rows, RegistryObserver>::make();
+//   ...
+//   auto snap = oneshot_registry::snapshot(10, std::chrono::seconds(5));
+//
+namespace oneshot_registry {
+
+struct ThreadList;
+
+// Per-state registration, embedded in the state through RegistryObserver::Data.
+struct Node {
+    Node* prev = nullptr;
+    Node* next = nullptr;
+    ThreadList* list = nullptr;  // set while linked
+    const char* label = nullptr;
+    std::uint64_t created = 0;  // Tsc ticks
+    std::thread::id thread;
+    std::size_t bytes = 0;
+    std::atomic<std::uint64_t> blocked_since{0};  // Tsc ticks; 0 while no receiver waits
+};
+
+class SpinLock {
+    std::atomic<bool> locked_{false};
+
+public:
+    void lock() noexcept {
+        while (locked_.exchange(true, std::memory_order_acquire)) {
+            while (locked_.load(std::memory_order_relaxed)) std::this_thread::yield();
+        }
+    }
+    void unlock() noexcept { locked_.store(false, std::memory_order_release); }
+};
+
+struct ThreadList {
+    SpinLock lock;
+    Node* head = nullptr;
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+    bool orphaned = false;  // owning thread exited; guarded by the registry mutex
+};
+
+struct Registry {
+    std::mutex mtx;
+    std::vector<std::unique_ptr<ThreadList>> lists;
+};
+
+inline Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// Owns this thread's list. A list outlives its thread while states made there
+// are still pending; snapshot() frees it once it is orphaned and empty.
+class LocalList {
+    ThreadList* list_;
+
+public:
+    LocalList() : list_(new ThreadList) {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        reg.lists.emplace_back(list_);
+    }
+    ~LocalList() {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        list_->orphaned = true;
+    }
+    LocalList(const LocalList&) = delete;
+    LocalList& operator=(const LocalList&) = delete;
+
+    ThreadList& get() noexcept { return *list_; }
+};
+
+inline ThreadList& local_list() {
+    static thread_local LocalList list;
+    return list.get();
+}
+
+// Unlinks `n` if it is registered. Callers serialize link/unlink of one node.
+inline void unlink(Node& n) noexcept {
+    ThreadList* l = n.list;
+    if (!l) return;
+    l->lock.lock();
+    if (n.prev) n.prev->next = n.next;
+    else l->head = n.next;
+    if (n.next) n.next->prev = n.prev;
+    --l->count;
+    l->bytes -= n.bytes;
+    l->lock.unlock();
+    n.list = nullptr;
+}
+
+// Registers `n` on the calling thread's list, (re)starting its age.
+inline void link(Node& n) {
+    unlink(n);
+    ThreadList& l = local_list();
+    n.label = oneshot_obs::current_label();
+    n.created = oneshot_obs::Tsc::now();
+    n.thread = std::this_thread::get_id();
+    n.blocked_since.store(0, std::memory_order_relaxed);
+    l.lock.lock();
+    n.prev = nullptr;
+    n.next = l.head;
+    if (l.head) l.head->prev = &n;
+    l.head = &n;
+    ++l.count;
+    l.bytes += n.bytes;
+    l.lock.unlock();
+    n.list = &l;
+}
+
+struct Entry {
+    const void* node = nullptr;  // identifies the state
+    const char* label = nullptr;
+    std::thread::id thread;      // thread that made or last re-armed it
+    std::chrono::nanoseconds age{0};
+    std::chrono::nanoseconds blocked{0};  // how long a receiver has been waiting, 0 if none
+    std::size_t bytes = 0;
+};
+
+struct Snapshot {
+    std::size_t outstanding = 0;  // pending states
+    std::size_t bytes = 0;        // their shared-state size, excluding allocator overhead
+    std::vector<Entry> oldest;    // oldest first
+    std::vector<Entry> blocked;   // receivers waiting longer than the threshold, longest first
+};
+
+//
+// Reports up to `max_oldest` of the oldest pending states and every receiver
+// blocked for longer than `blocked_longer_than`. Holds each thread's spinlock
+// only while walking that thread's list.
+//
+inline Snapshot snapshot(std::size_t max_oldest = 16,
+                         std::chrono::nanoseconds blocked_longer_than = std::chrono::seconds(1)) {
+    struct Raw {
+        const Node* node;
+        const char* label;
+        std::thread::id thread;
+        std::uint64_t created;
+        std::uint64_t blocked_since;
+        std::size_t bytes;
+    };
+    auto newer = [](const Raw& a, const Raw& b) { return a.created < b.created; };
+    std::priority_queue<Raw, std::vector<Raw>, decltype(newer)> oldest(newer);  // top is the newest kept
+    std::vector<Raw> blocked;
+
+    double tpn = oneshot_obs::Tsc::ticks_per_ns();
+    auto threshold = static_cast<std::uint64_t>(static_cast<double>(blocked_longer_than.count()) * tpn);
+
+    Snapshot snap;
+    std::uint64_t now = oneshot_obs::Tsc::now();
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        for (auto it = reg.lists.begin(); it != reg.lists.end();) {
+            ThreadList& l = **it;
+            l.lock.lock();
+            snap.outstanding += l.count;
+            snap.bytes += l.bytes;
+            for (const Node* n = l.head; n; n = n->next) {
+                Raw raw{n, n->label, n->thread, n->created, n->blocked_since.load(std::memory_order_relaxed), n->bytes};
+                if (max_oldest) {
+                    oldest.push(raw);
+                    if (oldest.size() > max_oldest) oldest.pop();
+                }
+                if (raw.blocked_since && now > raw.blocked_since && now - raw.blocked_since > threshold) {
+                    blocked.push_back(raw);
+                }
+            }
+            bool done = l.orphaned && l.count == 0;
+            l.lock.unlock();
+            if (done) it = reg.lists.erase(it);
+            else ++it;
+        }
+    }
+
+    auto ns = [tpn](std::uint64_t ticks) {
+        return std::chrono::nanoseconds(static_cast<std::int64_t>(static_cast<double>(ticks) / tpn));
+    };
+    auto entry = [&](const Raw& r) {
+        Entry e;
+        e.node = r.node;
+        e.label = r.label;
+        e.thread = r.thread;
+        e.age = ns(now > r.created ? now - r.created : 0);
+        if (r.blocked_since) e.blocked = ns(now > r.blocked_since ? now - r.blocked_since : 0);
+        e.bytes = r.bytes;
+        return e;
+    };
+
+    snap.oldest.resize(oldest.size());
+    for (std::size_t i = oldest.size(); i > 0; --i) {
+        snap.oldest[i - 1] = entry(oldest.top());
+        oldest.pop();
+    }
+    std::sort(blocked.begin(), blocked.end(),
+              [](const Raw& a, const Raw& b) { return a.blocked_since < b.blocked_since; });
+    for (const Raw& r : blocked) snap.blocked.push_back(entry(r));
+    return snap;
+}
+
+} // namespace oneshot_registry
+
+//
+// Observer policy that keeps pending states in oneshot_registry.
+//
+struct RegistryObserver {
+    struct Data : oneshot_registry::Node {
+        Data() = default;
+        Data(const Data&) = delete;
+        Data& operator=(const Data&) = delete;
+        ~Data() { oneshot_registry::unlink(*this); }
+    };
+
+    static std::uint64_t now() noexcept { return 0; }
+
+    // Templated so the registry can account for the full size of the state.
+    template<typename State>
+    static void on_create(State& s) noexcept {
+        Data& d = s;
+        d.bytes = sizeof(State);
+        oneshot_registry::link(d);
+    }
+    static void on_set(Data& d) noexcept { oneshot_registry::unlink(d); }
+    static void on_broken(Data& d) noexcept { oneshot_registry::unlink(d); }
+    static void on_wait(Data& d) noexcept {
+        d.blocked_since.store(oneshot_obs::Tsc::now() | 1, std::memory_order_relaxed);  // never 0
+    }
+    static void on_wake(Data& d, std::uint64_t) noexcept { d.blocked_since.store(0, std::memory_order_relaxed); }
+    static void on_timeout(Data& d, std::uint64_t) noexcept { d.blocked_since.store(0, std::memory_order_relaxed); }
+    static void on_consume(Data&) noexcept {}
+    static void on_reset(Data& d) noexcept { oneshot_registry::link(d); }
+};
@@ -0,0 +1,405 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "OneShotBlocking.hpp"
+#include "OneShotWait.hpp"
+
+//
+// Go-style select over OneShot and OneShotChannel receivers of any value types.
+//
+//   std::size_t taken = oneshot_select::select(
+//       oneshot_select::case_(reply, [](Reply r) { ... }),
+//       oneshot_select::case_(cancel, [] { ... }),          // OneShot<void> / OneShotChannel<void>
+//       oneshot_select::timeout(500ms, [] { ... }));
+//
+// Runs exactly one handler and returns the index of its clause:
+//
+//   - the first case (in argument order) whose receiver is ready; the handler
+//     gets the result of receiver.get(), so an exception stored in it (e.g.
+//     broken_promise) propagates out of select() instead
+//   - otherwise default_(f), if given, without waiting
+//   - otherwise the first case to become ready, or timeout(d, f) after d
+//
+// Empty receivers (moved from, or OneShot receivers already consumed) never
+// become ready, like nil channels in Go; a select with only those and no
+// timeout waits forever. A OneShot case consumes its receiver; a
+// OneShotChannel case leaves it usable for the next generation.
+//
+// All cases share one waiter: a node per case is linked into its receiver's
+// state, on select()'s own stack, and unlinked before select() returns, so
+// nothing is allocated. Under a fiber scheduler (OneShotFiber.hpp) the fiber
+// parks instead of the thread.
+//
+// when_n(k, receivers) waits for a quorum among OneShot receivers of one
+// value type; see below.
+//
+namespace oneshot_select {
+
+template<typename Receiver, typename F>
+struct Case {
+    Receiver& receiver;
+    F handler;
+};
+
+template<typename F>
+struct Timeout {
+    std::chrono::steady_clock::duration after;
+    F handler;
+};
+
+template<typename F>
+struct Default {
+    F handler;
+};
+
+template<typename Receiver, typename F>
+Case<Receiver, std::decay_t<F>> case_(Receiver& r, F&& handler) {
+    return {r, std::forward<F>(handler)};
+}
+
+template<typename Rep, typename Period, typename F>
+Timeout<std::decay_t<F>> timeout(const std::chrono::duration<Rep, Period>& after, F&& handler) {
+    return {std::chrono::duration_cast<std::chrono::steady_clock::duration>(after), std::forward<F>(handler)};
+}
+
+template<typename F>
+Default<std::decay_t<F>> default_(F&& handler) {
+    return {std::forward<F>(handler)};
+}
+
+namespace detail {
+
+template<typename C>
+struct is_case : std::false_type {};
+template<typename R, typename F>
+struct is_case<Case<R, F>> : std::true_type {};
+
+template<typename C>
+struct is_timeout : std::false_type {};
+template<typename F>
+struct is_timeout<Timeout<F>> : std::true_type {};
+
+template<typename C>
+struct is_default : std::false_type {};
+template<typename F>
+struct is_default<Default<F>> : std::true_type {};
+
+// Calls f(clause, index) in order until one returns true; returns whether one did.
+template<typename Tuple, typename F, std::size_t... I>
+bool any_of(Tuple& clauses, F&& f, std::index_sequence<I...>) {
+    return (f(std::get<I>(clauses), I) || ...);
+}
+
+template<typename R, typename F>
+void run(Case<R, F>& c) {
+    if constexpr (std::is_void<decltype(c.receiver.get())>::value) {
+        c.receiver.get();
+        c.handler();
+    } else {
+        c.handler(c.receiver.get());
+    }
+}
+
+template<typename C>
+void run(C& c) {
+    c.handler();
+}
+
+//
+// The single waiter behind all cases: signalled by the first case whose node
+// is notified. Parks the current fiber when a Parker is installed.
+//
+class Waiter {
+    std::atomic<bool> signalled_{false};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    oneshot_detail::Parker* parker_ = oneshot_detail::current_parker();
+    oneshot_detail::WaitNode park_node_;
+
+public:
+    Waiter() {
+        if (parker_) parker_->prepare(park_node_);
+    }
+    Waiter(const Waiter&) = delete;
+    Waiter& operator=(const Waiter&) = delete;
+
+    static void on_notify(oneshot_detail::WaitNode* n) noexcept { static_cast<Waiter*>(n->ctx)->signal(); }
+
+    void signal() noexcept {
+        if (signalled_.exchange(true, std::memory_order_acq_rel)) return;
+        if (parker_) {
+            park_node_.notify(&park_node_);
+            return;
+        }
+        { std::lock_guard<std::mutex> lock(mtx_); }
+        cv_.notify_one();
+    }
+
+    // Returns once signalled or once `deadline` (if given) has passed.
+    void wait(const std::chrono::steady_clock::time_point* deadline) {
+        if (parker_) {
+            // a prepared parker must park, even if already signalled
+            parker_->park(park_node_, deadline);
+            return;
+        }
+        if (deadline) {
+            oneshot_blocking::check_timed_wait(*deadline - std::chrono::steady_clock::now(),
+                                               [this] { return signalled_.load(std::memory_order_acquire); });
+        } else {
+            oneshot_blocking::check_wait([this] { return signalled_.load(std::memory_order_acquire); });
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!signalled_.load(std::memory_order_acquire)) {
+            if (!deadline) cv_.wait(lock);
+            else if (cv_.wait_until(lock, *deadline) == std::cv_status::timeout) return;
+        }
+    }
+};
+
+} // namespace detail
+
+template<typename... Clauses>
+std::size_t select(Clauses&&... clauses) {
+    constexpr std::size_t n = sizeof...(Clauses);
+    constexpr std::size_t timeouts = (std::size_t(0) + ... + detail::is_timeout<std::decay_t<Clauses>>::value);
+    constexpr std::size_t defaults = (std::size_t(0) + ... + detail::is_default<std::decay_t<Clauses>>::value);
+    static_assert(n > 0, "select() needs at least one clause");
+    static_assert(timeouts + defaults <= 1, "select() takes at most one timeout() or default_() clause");
+
+    std::tuple<std::decay_t<Clauses>&...> cs(clauses...);
+    constexpr auto each = std::index_sequence_for<Clauses...>{};
+    std::size_t taken = n;
+
+    auto take_ready = [&](auto& c, std::size_t i) {
+        if constexpr (detail::is_case<std::decay_t<decltype(c)>>::value) {
+            if (!c.receiver.ready()) return false;
+            taken = i;
+            detail::run(c);
+            return true;
+        }
+        return false;
+    };
+    auto take_default = [&](auto& c, std::size_t i) {
+        if constexpr (detail::is_default<std::decay_t<decltype(c)>>::value) {
+            taken = i;
+            detail::run(c);
+            return true;
+        }
+        return false;
+    };
+    auto take_timeout = [&](auto& c, std::size_t i) {
+        if constexpr (detail::is_timeout<std::decay_t<decltype(c)>>::value) {
+            taken = i;
+            detail::run(c);
+            return true;
+        }
+        return false;
+    };
+
+    if (detail::any_of(cs, take_ready, each)) return taken;
+    if constexpr (defaults > 0) {
+        detail::any_of(cs, take_default, each);
+        return taken;
+    }
+
+    std::chrono::steady_clock::time_point deadline{};
+    detail::any_of(cs, [&](auto& c, std::size_t) {
+        if constexpr (detail::is_timeout<std::decay_t<decltype(c)>>::value) {
+            deadline = std::chrono::steady_clock::now() + c.after;
+            return true;
+        }
+        return false;
+    }, each);
+
+    for (;;) {
+        oneshot_detail::WaitNode nodes[n];
+        bool linked[n] = {};
+        {
+            detail::Waiter waiter;
+            detail::any_of(cs, [&](auto& c, std::size_t i) {
+                if constexpr (detail::is_case<std::decay_t<decltype(c)>>::value) {
+                    auto& state = oneshot_detail::Access::state(c.receiver);
+                    if (!state) return false;
+                    nodes[i].notify = &detail::Waiter::on_notify;
+                    nodes[i].ctx = &waiter;
+                    if ((linked[i] = state->add_waiter(nodes[i]))) return false;
+                    waiter.signal();  // became ready meanwhile
+                    return true;
+                }
+                return false;
+            }, each);
+
+            waiter.wait(timeouts > 0 ? &deadline : nullptr);
+
+            // also for nodes already notified: remove_waiter returns only once
+            // their notification has finished with `waiter`
+            detail::any_of(cs, [&](auto& c, std::size_t i) {
+                if constexpr (detail::is_case<std::decay_t<decltype(c)>>::value) {
+                    if (linked[i]) oneshot_detail::Access::state(c.receiver)->remove_waiter(nodes[i]);
+                }
+                return false;
+            }, each);
+        }
+
+        if (detail::any_of(cs, take_ready, each)) return taken;
+        if constexpr (timeouts > 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                detail::any_of(cs, take_timeout, each);
+                return taken;
+            }
+        }
+        // woken without a ready case (e.g. a channel was reset): wait again
+    }
+}
+
+namespace detail {
+
+template<typename T>
+struct QuorumValues {
+    std::vector<T> values;  // values[j] came from receivers[indices[j]]
+};
+template<>
+struct QuorumValues<void> {};
+
+// Completions seen by one when_n() call; the one that reaches either
+// threshold signals the waiter, so it is woken once.
+struct QuorumCount {
+    Waiter& waiter;
+    std::size_t need_values;
+    std::size_t need_errors;
+    std::size_t* order;  // indices in completion order, `seen` of them written
+    std::atomic<std::size_t> values{0};
+    std::atomic<std::size_t> errors{0};
+    std::atomic<std::size_t> seen{0};
+
+    void completed(std::size_t index, bool failed) noexcept {
+        order[seen.fetch_add(1, std::memory_order_relaxed)] = index;
+        std::size_t n = (failed ? errors : values).fetch_add(1, std::memory_order_acq_rel) + 1;
+        if (n == (failed ? need_errors : need_values)) waiter.signal();
+    }
+
+    bool decided() const noexcept {
+        return values.load(std::memory_order_acquire) >= need_values ||
+               errors.load(std::memory_order_acquire) >= need_errors;
+    }
+};
+
+template<typename State>
+struct QuorumNode {
+    oneshot_detail::WaitNode node;
+    QuorumCount* count = nullptr;
+    State* state = nullptr;
+    std::size_t index = 0;
+    bool linked = false;
+
+    // runs on the completing thread, after the result was written
+    static void on_notify(oneshot_detail::WaitNode* n) noexcept {
+        auto* self = static_cast<QuorumNode*>(n->ctx);
+        self->count->completed(self->index, self->state->error != nullptr);
+    }
+};
+
+} // namespace detail
+
+template<typename T>
+struct Quorum : detail::QuorumValues<T> {
+    bool ok = false;                   // k values arrived
+    std::vector<std::size_t> indices;  // receivers that delivered a value, in arrival order
+    std::vector<std::pair<std::size_t, std::exception_ptr>> errors;  // (index, error), in arrival order
+};
+
+//
+// Quorum wait over n OneShot receivers of one value type:
+//
+//   std::vector<OneShot<Reply>::Receiver> replies = ...;  // one per replica
+//   auto q = oneshot_select::when_n(2, replies);
+//   if (q.ok) merge(q.values);                            // from replies[q.indices[j]]
+//
+// Returns once k receivers delivered a value, or once n - k + 1 failed (the
+// quorum can no longer be reached). A node linked into each state counts
+// completions, and only the one that reaches either threshold wakes the
+// caller, however many replies arrive. Every receiver counted by then is
+// consumed into the result, in the order they completed; the others are
+// stragglers and are dropped, which their senders see as cancelled() (and
+// through try_set_value / set_value_and_wait). An empty receiver counts as
+// failed at once, with a no_state future_error.
+// Throws std::invalid_argument unless 0 < k <= n.
+//
+template<typename Receiver>
+auto when_n(std::size_t k, Receiver* receivers, std::size_t n) {
+    using T = typename Receiver::value_type;
+    using State = typename std::decay_t<decltype(oneshot_detail::Access::state(*receivers))>::element_type;
+    if (k == 0 || k > n) throw std::invalid_argument("when_n: k must be between 1 and the number of receivers");
+
+    std::vector<detail::QuorumNode<State>> nodes(n);
+    std::vector<std::size_t> order(n);
+    std::size_t seen;
+    {
+        detail::Waiter waiter;
+        detail::QuorumCount count{waiter, k, n - k + 1, order.data()};
+        for (std::size_t i = 0; i < n && !count.decided(); ++i) {
+            auto& state = oneshot_detail::Access::state(receivers[i]);
+            if (!state) {
+                count.completed(i, true);  // get() below records no_state
+                continue;
+            }
+            auto& qn = nodes[i];
+            qn.node.notify = &detail::QuorumNode<State>::on_notify;
+            qn.node.ctx = &qn;
+            qn.count = &count;
+            qn.state = state.get();
+            qn.index = i;
+            if (!(qn.linked = state->add_waiter(qn.node))) count.completed(i, state->error != nullptr);
+        }
+
+        waiter.wait(nullptr);
+
+        // as in select(): returns only once a running notification is done with `count`
+        for (auto& qn : nodes) {
+            if (qn.linked) qn.state->remove_waiter(qn.node);
+        }
+        seen = count.seen.load(std::memory_order_acquire);
+    }
+
+    Quorum<T> q;
+    q.indices.reserve(seen);
+    if constexpr (!std::is_void<T>::value) q.values.reserve(seen);
+    for (std::size_t j = 0; j < seen; ++j) {
+        std::size_t i = order[j];
+        try {
+            if constexpr (std::is_void<T>::value) receivers[i].get();
+            else q.values.push_back(receivers[i].get());
+            q.indices.push_back(i);
+        } catch (...) {
+            q.errors.emplace_back(i, std::current_exception());
+        }
+    }
+    q.ok = q.indices.size() >= k;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (receivers[i]) receivers[i] = Receiver{};  // straggler: cancel
+    }
+    return q;
+}
+
+// Same for contiguous ranges (std::vector, std::array, ...).
+template<typename Receivers>
+auto when_n(std::size_t k, Receivers& receivers) -> decltype(when_n(k, receivers.data(), receivers.size())) {
+    return when_n(k, receivers.data(), receivers.size());
+}
+
+} // namespace oneshot_select
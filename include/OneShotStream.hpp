@@ -0,0 +1,152 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "OneShotStream.hpp requires C++20 coroutines"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+
+#include "OneShotChannel.hpp"
+
+//
+// Coroutine stream over a reusable OneShotChannel: each co_await yields the
+// next value the sender sets, and the stream re-arms the channel itself, so
+// the producer only calls set_value() and the consumer never resets.
+//
+//   auto [tx, rx] = OneShotChannel<Event>::make();
+//   auto events = oneshot_stream::stream(rx);
+//   while (auto e = co_await events.next()) handle(*e);   // std::optional<Event>
+//
+// (C++20 has no `for co_await`; next() returns std::optional<T>, or bool for
+// OneShotChannel<void>, and is empty once the stream has ended.)
+//
+// - A value already set is taken without suspending; otherwise the coroutine
+//   suspends on a WaitNode inside the Stream and is resumed by set_value(), on
+//   the producer's thread.
+// - Taking a value re-arms the channel under the same lock; the value is
+//   moved out of the channel's inline storage, so no allocation per element.
+// - The stream ends when the Sender is dropped, after any value it set has
+//   been yielded. Other exceptions set by the sender are rethrown from
+//   co_await, and the stream continues with the next value.
+//
+// set_value() returns false while the previous value has not been taken yet;
+// the producer decides whether to retry or drop. A channel should have one
+// stream and no other resets while it is in use.
+//
+namespace oneshot_stream {
+
+template<typename Receiver>
+class Stream {
+    using T = decltype(std::declval<Receiver&>().get());
+    using Result = oneshot_detail::TimedResult<T>;
+
+    Receiver& receiver_;
+    oneshot_detail::WaitNode node_;
+    std::coroutine_handle<> waiting_;
+    // A coroutine waits in next(); cleared by whichever of on_ready() and
+    // ~Stream gets there first, so exactly one of them owns the wakeup.
+    std::atomic<bool> suspended_{false};
+    bool done_ = false;   // result_/error_ hold the outcome of the next co_await
+    Result result_{};     // empty at the end of the stream
+    std::exception_ptr error_;
+
+    auto& state() noexcept { return *oneshot_detail::Access::state(receiver_); }
+
+    // Takes the current generation if it is set (re-arming the channel), or
+    // ends the stream once the sender is gone. Returns whether done_ is set.
+    bool poll() {
+        if (done_) return true;
+        if (!oneshot_detail::Access::state(receiver_)) {
+            done_ = true;
+            return true;
+        }
+        auto& st = state();
+        auto lock = st.lock(st.receiver_counters);
+        if (!st.used) {
+            if (!st.sender_gone) return false;
+            done_ = true;
+            return true;
+        }
+        done_ = true;
+        if (st.broken) return true;  // the sender was dropped without a last value
+        if (st.error) {
+            error_ = st.error;
+        } else {
+            try {
+                if constexpr (std::is_void<T>::value) result_ = true;
+                else result_.emplace(std::move(*st.value));
+            } catch (...) {
+                error_ = std::current_exception();
+            }
+        }
+        st.hand_off_locked(RendezvousResult::Consumed);
+        st.reset_locked(st.receiver_counters);
+        return true;
+    }
+
+    // Polls, then links the node until the next set; true if linked.
+    bool arm() {
+        for (;;) {
+            if (poll()) return false;
+            node_.notify = &Stream::on_ready;
+            node_.ctx = this;
+            if (state().add_waiter(node_)) return true;
+        }
+    }
+
+    static void on_ready(oneshot_detail::WaitNode* n) noexcept {
+        auto* self = static_cast<Stream*>(n->ctx);
+        if (self->arm()) return;
+        auto h = self->waiting_;
+        // lost to ~Stream, which is waiting in remove_waiter() for us to return
+        if (self->suspended_.exchange(false, std::memory_order_acq_rel)) h.resume();
+    }
+
+    struct Next {
+        Stream& s;
+
+        bool await_ready() { return s.poll(); }
+        bool await_suspend(std::coroutine_handle<> h) {
+            s.waiting_ = h;
+            s.suspended_.store(true, std::memory_order_relaxed);  // published by add_waiter's lock
+            if (s.arm()) return true;
+            s.suspended_.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        Result await_resume() {
+            s.done_ = false;
+            if (auto e = std::exchange(s.error_, nullptr)) std::rethrow_exception(e);
+            return std::exchange(s.result_, Result{});
+        }
+    };
+
+public:
+    explicit Stream(Receiver& r) : receiver_(r) {}
+    Stream(const Stream&) = delete;
+    Stream& operator=(const Stream&) = delete;
+
+    // A coroutine destroyed while suspended in next() leaves nothing linked,
+    // and waits out a completion that is running on_ready() for it. Destroyed
+    // while running (possibly inside on_ready(), resumed inline), it has
+    // nothing linked and must not wait for its own notification.
+    ~Stream() {
+        if (suspended_.exchange(false, std::memory_order_acq_rel)) state().remove_waiter(node_);
+    }
+
+    // Awaitable: std::optional<T> (bool for void), empty once the stream ended.
+    Next next() { return Next{*this}; }
+};
+
+template<typename Receiver>
+Stream<Receiver> stream(Receiver& r) {
+    return Stream<Receiver>(r);
+}
+
+} // namespace oneshot_stream
@@ -0,0 +1,331 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "OneShotObserver.hpp"
+
+//
+// Lifecycle tracing for OneShot<T, TraceObserver> and OneShotChannel<T, TraceObserver>.
+//
+// Every make, set, broken, wake, timeout, consume and reset is recorded as one
+// event (thread, timestamp, label) in a lock-free ring buffer owned by the
+// recording thread. write_chrome_json() flushes all rings as Chrome trace
+// events, which chrome://tracing and ui.perfetto.dev both load; a flow arrow
+// links each set to the wake it released, across threads.
+//
+// A thread's ring (about 400 KB) is allocated on its first event; if that
+// fails the event is dropped. Once the thread exits, its ring is released as
+// soon as its events were written out or cleared, and at most
+// Registry::kMaxExited rings of exited threads are kept unwritten, oldest
+// dropped first.
+//
+// Labels come from the ScopedLabel active on the thread that calls make() and
+// must outlive the trace (string literals are typical):
+//
+//   oneshot_trace::ScopedLabel label("fetch_user");
+//   auto [s, r] = OneShot<User, TraceObserver>::make();
+//
+namespace oneshot_trace {
+
+enum class Kind : std::uint8_t { Make, Set, Broken, Wake, Timeout, Consume, Reset };
+
+struct Event {
+    std::uint64_t ts = 0;   // steady_clock ns
+    std::uint64_t dur = 0;  // ns; wait time for Wake/Timeout
+    std::uint64_t id = 0;   // flow id of the one-shot (new per channel generation)
+    const char* label = nullptr;
+    Kind kind = Kind::Make;
+};
+
+//
+// Single-producer ring: only the owning thread pushes. Each slot is a seqlock:
+// its sequence is odd while the owner rewrites it and 2 * (index + 1) once
+// event `index` is complete, so readers skip slots that are being written or
+// were lapped while they copied.
+//
+struct Ring {
+    static constexpr std::size_t kEvents = 8192;
+
+    struct Slot {
+        std::atomic<std::uint64_t> seq{0};
+        std::atomic<std::uint64_t> ts{0}, dur{0}, id{0};
+        std::atomic<const char*> label{nullptr};
+        std::atomic<Kind> kind{Kind::Make};
+    };
+
+    std::uint32_t tid = 0;
+    std::atomic<std::uint64_t> head{0};
+    std::atomic<std::uint64_t> floor{0};  // events before this were cleared
+    std::atomic<bool> exited{false};      // set by the owning thread on exit, after its last push
+    std::uint64_t written = 0;            // head at the last export; guarded by the registry lock
+    Slot slots[kEvents];
+
+    void push(const Event& e) noexcept {
+        std::uint64_t h = head.load(std::memory_order_relaxed);
+        Slot& s = slots[h % kEvents];
+        s.seq.store(2 * h + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.ts.store(e.ts, std::memory_order_relaxed);
+        s.dur.store(e.dur, std::memory_order_relaxed);
+        s.id.store(e.id, std::memory_order_relaxed);
+        s.label.store(e.label, std::memory_order_relaxed);
+        s.kind.store(e.kind, std::memory_order_relaxed);
+        s.seq.store(2 * h + 2, std::memory_order_release);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Copies event `i` into `e`; false if the slot no longer (or not yet) holds it whole.
+    bool read(std::uint64_t i, Event& e) const noexcept {
+        const Slot& s = slots[i % kEvents];
+        std::uint64_t seq = s.seq.load(std::memory_order_acquire);
+        if (seq != 2 * i + 2) return false;
+        e.ts = s.ts.load(std::memory_order_relaxed);
+        e.dur = s.dur.load(std::memory_order_relaxed);
+        e.id = s.id.load(std::memory_order_relaxed);
+        e.label = s.label.load(std::memory_order_relaxed);
+        e.kind = s.kind.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return s.seq.load(std::memory_order_relaxed) == seq;
+    }
+
+    // Appends the buffered events to `out`; returns the head they were read up to.
+    std::uint64_t collect(std::vector<Event>& out) const {
+        std::uint64_t h = head.load(std::memory_order_acquire);
+        std::uint64_t begin = h > kEvents ? h - kEvents : 0;
+        begin = std::max(begin, floor.load(std::memory_order_relaxed));
+        Event e;
+        for (std::uint64_t i = begin; i < h; ++i) {
+            if (read(i, e)) out.push_back(e);
+        }
+        return h;
+    }
+
+    // The owner exited and every event it pushed was exported or cleared.
+    bool spent() const noexcept {
+        if (!exited.load(std::memory_order_acquire)) return false;
+        std::uint64_t h = head.load(std::memory_order_acquire);
+        return h <= std::max(written, floor.load(std::memory_order_relaxed));
+    }
+};
+
+struct Registry {
+    static constexpr std::size_t kMaxExited = 16;  // unexported rings of exited threads kept
+
+    std::mutex mtx;
+    std::vector<std::shared_ptr<Ring>> rings;  // in registration order
+    std::uint32_t next_tid = 1;
+
+    // Releases spent rings, then the oldest rings of exited threads beyond
+    // kMaxExited. Caller holds mtx.
+    void prune_locked() noexcept {
+        rings.erase(std::remove_if(rings.begin(), rings.end(), [](const auto& r) { return r->spent(); }),
+                    rings.end());
+        std::size_t exited = 0;
+        for (auto& r : rings) exited += r->exited.load(std::memory_order_acquire);
+        for (auto it = rings.begin(); exited > kMaxExited && it != rings.end();) {
+            if ((*it)->exited.load(std::memory_order_acquire)) {
+                it = rings.erase(it);
+                --exited;
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
+inline Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// The calling thread's ring, registered on first use; nullptr if it could not
+// be allocated (the caller drops its event, and the next one tries again).
+inline Ring* local_ring() noexcept {
+    struct Owner {
+        std::shared_ptr<Ring> ring;
+        ~Owner() {
+            if (ring) ring->exited.store(true, std::memory_order_release);
+        }
+    };
+    static thread_local Owner owner;
+    if (!owner.ring) {
+        try {
+            auto r = std::make_shared<Ring>();
+            auto& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mtx);
+            reg.prune_locked();
+            reg.rings.push_back(r);
+            r->tid = reg.next_tid++;
+            owner.ring = std::move(r);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+    return owner.ring.get();
+}
+
+inline std::uint64_t now_ns() noexcept {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+inline std::uint64_t next_id() noexcept {
+    static std::atomic<std::uint64_t> id{0};
+    return id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+using oneshot_obs::current_label;
+using oneshot_obs::ScopedLabel;
+
+// Forgets every event recorded so far.
+inline void clear() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    for (auto& r : reg.rings) r->floor.store(r->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    reg.prune_locked();
+}
+
+namespace detail {
+
+inline const char* name(Kind k) noexcept {
+    switch (k) {
+    case Kind::Make: return "make";
+    case Kind::Set: return "set";
+    case Kind::Broken: return "broken";
+    case Kind::Wake: return "wake";
+    case Kind::Timeout: return "timeout";
+    case Kind::Consume: return "consume";
+    case Kind::Reset: return "reset";
+    }
+    return "?";
+}
+
+// Microseconds with nanosecond precision, as the trace format expects.
+inline void write_us(std::ostream& os, std::uint64_t ns) {
+    static const char digits[] = "0123456789";
+    char frac[4] = {digits[ns / 100 % 10], digits[ns / 10 % 10], digits[ns % 10], 0};
+    os << ns / 1000 << '.' << frac;
+}
+
+inline void write_string(std::ostream& os, const char* s) {
+    os << '"';
+    for (; s && *s; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') os << '\\' << *s;
+        else if (c < 0x20) os << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 15];
+        else os << *s;
+    }
+    os << '"';
+}
+
+} // namespace detail
+
+//
+// Writes every buffered event as Chrome trace JSON. Wake and timeout events
+// become slices spanning the receiver's wait; the rest are zero-length slices.
+// Safe to call while other threads record: events lapped during the copy are
+// skipped. Rings of threads that have exited are released afterwards.
+//
+inline void write_chrome_json(std::ostream& os) {
+    std::vector<std::pair<std::uint32_t, std::vector<Event>>> threads;
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mtx);
+        for (auto& r : reg.rings) {
+            threads.emplace_back(r->tid, std::vector<Event>{});
+            r->written = r->collect(threads.back().second);
+        }
+        reg.prune_locked();  // exited threads' rings are no longer needed
+    }
+
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    auto begin = [&] {
+        os << (first ? "\n" : ",\n");
+        first = false;
+    };
+    for (auto& [tid, events] : threads) {
+        for (const Event& e : events) {
+            std::uint64_t start = e.ts - e.dur;
+            begin();
+            os << "{\"name\":\"" << detail::name(e.kind) << "\",\"cat\":\"oneshot\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+               << tid << ",\"ts\":";
+            detail::write_us(os, start);
+            os << ",\"dur\":";
+            detail::write_us(os, e.dur);
+            os << ",\"args\":{\"label\":";
+            detail::write_string(os, e.label);
+            os << ",\"id\":" << e.id << "}}";
+
+            // set/broken start a flow that ends at the receiver's wake
+            if (e.kind == Kind::Set || e.kind == Kind::Broken || e.kind == Kind::Wake) {
+                begin();
+                os << "{\"name\":\"handoff\",\"cat\":\"oneshot\",\"ph\":\"" << (e.kind == Kind::Wake ? "f" : "s")
+                   << "\",\"bp\":\"e\",\"id\":" << e.id << ",\"pid\":1,\"tid\":" << tid << ",\"ts\":";
+                detail::write_us(os, e.ts);
+                os << "}";
+            }
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+} // namespace oneshot_trace
+
+//
+// Observer policy that records the lifecycle into oneshot_trace's rings.
+//
+struct TraceObserver {
+    struct Data {
+        const char* label = nullptr;
+        // rewritten by a channel's reset() while receivers may still record
+        std::atomic<std::uint64_t> id{0};
+    };
+
+    static std::uint64_t now() noexcept { return oneshot_trace::now_ns(); }
+
+    static void on_create(Data& d) noexcept {
+        d.label = oneshot_trace::current_label();
+        d.id.store(oneshot_trace::next_id(), std::memory_order_relaxed);
+        record(d, oneshot_trace::Kind::Make);
+    }
+    static void on_set(Data& d) noexcept { record(d, oneshot_trace::Kind::Set); }
+    static void on_broken(Data& d) noexcept { record(d, oneshot_trace::Kind::Broken); }
+    static void on_wait(Data&) noexcept {}
+    static void on_wake(Data& d, std::uint64_t wait_begin) noexcept {
+        record(d, oneshot_trace::Kind::Wake, wait_begin);
+    }
+    static void on_timeout(Data& d, std::uint64_t wait_begin) noexcept {
+        record(d, oneshot_trace::Kind::Timeout, wait_begin);
+    }
+    static void on_consume(Data& d) noexcept { record(d, oneshot_trace::Kind::Consume); }
+    static void on_reset(Data& d) noexcept {
+        record(d, oneshot_trace::Kind::Reset);
+        // the next generation is a separate flow
+        d.id.store(oneshot_trace::next_id(), std::memory_order_relaxed);
+    }
+
+private:
+    static void record(const Data& d, oneshot_trace::Kind kind, std::uint64_t since = 0) noexcept {
+        oneshot_trace::Event e;
+        e.ts = now();
+        e.dur = since && since < e.ts ? e.ts - since : 0;
+        e.id = d.id.load(std::memory_order_relaxed);
+        e.label = d.label;
+        e.kind = kind;
+        if (auto* ring = oneshot_trace::local_ring()) ring->push(e);
+    }
+};
@@ -0,0 +1,95 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <chrono>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "OneShotError.hpp"
+
+// Outcome of Sender::set_value_and_wait / set_value_and_wait_for.
+enum class RendezvousResult {
+    Consumed,      // a receiver took the value
+    ReceiverGone,  // the receiving side was dropped without taking it
+    Discarded,     // OneShotChannel only: a reset() dropped the value unread
+    TimedOut,      // set_value_and_wait_for only: the value stays set
+    Rejected,      // not set: the sender is empty or already completed
+};
+
+//
+// What differs between a one-shot of T and of void, factored out so that
+// OneShot and OneShotChannel each need a single implementation.
+//
+namespace oneshot_detail {
+
+// Result of a timed get: std::optional<T>, or bool for void.
+template<typename T>
+using TimedResult = std::conditional_t<std::is_void<T>::value, bool, std::optional<T>>;
+
+// Payload storage of a OneShot state: nothing for void.
+template<typename T>
+struct Payload {
+    std::optional<T> value;
+};
+template<>
+struct Payload<void> {};
+
+//
+// Provides Sender::set_value(T), or set_value() for void, forwarding to
+// `Sender::complete_value(args...)`.
+//
+template<typename Sender, typename T>
+struct SetValue {
+    bool set_value(T value) { return static_cast<Sender&>(*this).complete_value(std::move(value)); }
+};
+template<typename Sender>
+struct SetValue<Sender, void> {
+    bool set_value() { return static_cast<Sender&>(*this).complete_value(); }
+};
+
+//
+// Provides Sender::try_set_value(T&&) -> std::optional<T> for OneShot<T>,
+// forwarding to `Sender::try_complete_value(T&&)`; nothing for void.
+//
+template<typename Sender, typename T>
+struct TrySetValue {
+    std::optional<T> try_set_value(T&& value) {
+        return static_cast<Sender&>(*this).try_complete_value(std::move(value));
+    }
+};
+template<typename Sender>
+struct TrySetValue<Sender, void> {};
+
+//
+// Provides Sender::set_value_and_wait(T) and set_value_and_wait_for(T, d), or
+// the same without a value for void, forwarding to
+// `Sender::complete_and_wait(deadline, args...)`.
+//
+template<typename Sender, typename T>
+struct SetValueAndWait {
+    RendezvousResult set_value_and_wait(T value) {
+        return static_cast<Sender&>(*this).complete_and_wait(nullptr, std::move(value));
+    }
+    template<typename Rep, typename Period>
+    RendezvousResult set_value_and_wait_for(T value, const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+        return static_cast<Sender&>(*this).complete_and_wait(&deadline, std::move(value));
+    }
+};
+template<typename Sender>
+struct SetValueAndWait<Sender, void> {
+    RendezvousResult set_value_and_wait() { return static_cast<Sender&>(*this).complete_and_wait(nullptr); }
+    template<typename Rep, typename Period>
+    RendezvousResult set_value_and_wait_for(const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+        return static_cast<Sender&>(*this).complete_and_wait(&deadline);
+    }
+};
+
+} // namespace oneshot_detail
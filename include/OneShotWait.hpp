@@ -0,0 +1,378 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <condition_variable>
+#include <utility>
+
+#include "OneShotBlocking.hpp"
+
+namespace oneshot_layout {
+
+// Cache line size used to keep independently written data apart.
+#if defined(ONESHOT_CACHE_LINE)
+inline constexpr std::size_t cache_line = ONESHOT_CACHE_LINE;
+#elif defined(__cpp_lib_hardware_interference_size) && !defined(__GNUC__)
+inline constexpr std::size_t cache_line = std::hardware_destructive_interference_size;
+#else
+// GCC warns that its hardware_destructive_interference_size may differ
+// between translation units (-Winterference-size), so assume 64 there
+inline constexpr std::size_t cache_line = 64;
+#endif
+
+} // namespace oneshot_layout
+
+//
+// Completion and waiting machinery shared by the one-shot headers.
+//
+namespace oneshot_detail {
+
+//
+// Intrusive waiter registered on a Core. `notify` runs exactly once, on the
+// completing thread and outside the core's lock, when the core completes. It
+// may consume the result or destroy the node, but must not remove other nodes
+// from the same core. Nodes live in the waiter's own storage (stack, fiber
+// stack, coroutine frame, operation state), so registering never allocates.
+//
+struct WaitNode {
+    void (*notify)(WaitNode*) noexcept = nullptr;
+    void* ctx = nullptr;
+    WaitNode* prev = nullptr;
+    WaitNode* next = nullptr;
+    bool linked = false;
+};
+
+//
+// Suspends the current execution context instead of blocking the thread.
+// User-space schedulers install one per carrier thread while a task runs
+// (see OneShotFiber.hpp); plain threads have none and block as usual.
+//
+struct Parker {
+    virtual ~Parker() = default;
+    // Sets up node.notify/ctx so that notification resumes the current context.
+    virtual void prepare(WaitNode& node) = 0;
+    // Suspends until `node` was notified or `deadline` (if given) has passed.
+    virtual void park(WaitNode& node, const std::chrono::steady_clock::time_point* deadline) = 0;
+};
+
+// Grants the one-shot adapters (execution, forwarding, select, ...) access to
+// the state behind a Sender or Receiver without widening their public API.
+struct Access {
+    template<typename Handle>
+    static auto& state(Handle& h) noexcept { return h.state_; }
+};
+
+inline Parker*& current_parker() noexcept {
+    static thread_local Parker* parker = nullptr;
+    return parker;
+}
+
+//
+// Waits, with `lock` held, until `done()` holds or `deadline` (if given) has
+// passed; returns done(). Threads block on `cv`; fibers park through the
+// installed Parker with their node published in `slot`. Whoever makes done()
+// true calls wake_slot() under the same lock. One waiter per slot.
+//
+template<typename Done>
+bool wait_locked(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, WaitNode*& slot, Done&& done,
+                 const std::chrono::steady_clock::time_point* deadline) {
+    if (done()) return true;
+    Parker* p = current_parker();
+    if (!p) {
+        if (!deadline) oneshot_blocking::check_wait([] { return false; });
+        else oneshot_blocking::check_timed_wait(*deadline - std::chrono::steady_clock::now(), [] { return false; });
+        while (!done()) {
+            if (!deadline) cv.wait(lock);
+            else if (cv.wait_until(lock, *deadline) == std::cv_status::timeout) return done();
+        }
+        return true;
+    }
+    while (!done()) {
+        if (deadline && std::chrono::steady_clock::now() >= *deadline) return false;
+        WaitNode node;
+        p->prepare(node);
+        slot = &node;
+        lock.unlock();
+        p->park(node, deadline);
+        lock.lock();
+        if (slot == &node) slot = nullptr;  // timed out: nobody notified it
+    }
+    return true;
+}
+
+// Wakes the waiter of wait_locked(); call with the same lock held.
+inline void wake_slot(WaitNode*& slot, std::condition_variable& cv) noexcept {
+    if (WaitNode* n = std::exchange(slot, nullptr)) n->notify(n);
+    cv.notify_all();
+}
+
+//
+// Completion state of one shot: claim -> publish, plus blocking, timed and
+// intrusive waits. The payload lives in the derived state.
+//
+class Core {
+    enum : std::uint32_t { Claimed = 1, Ready = 2, Waiters = 4, ReceiverGone = 8, SenderWaits = 16, Taken = 32 };
+
+    std::atomic<std::uint32_t> flags_{0};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    WaitNode* head_ = nullptr;
+    WaitNode* sender_node_ = nullptr;  // a fiber parked in wait_taken()
+    bool notifying_ = false;           // a detached waiter list is being notified
+
+public:
+    // Grants the right to write the payload exactly once.
+    bool claim() noexcept { return !(flags_.fetch_or(Claimed, std::memory_order_acq_rel) & Claimed); }
+
+    bool claimed() const noexcept { return flags_.load(std::memory_order_acquire) & Claimed; }
+
+    // The receiving side was dropped without taking the result: a payload
+    // written now would only be destroyed with the state.
+    void drop_receiver() noexcept {
+        if (flags_.fetch_or(ReceiverGone, std::memory_order_acq_rel) & SenderWaits) wake_sender();
+    }
+
+    bool receiver_gone() const noexcept { return flags_.load(std::memory_order_acquire) & ReceiverGone; }
+
+    // Rendezvous (set_value_and_wait): claims like claim(), and tells the
+    // receiving side that the sender will wait for the result to be taken.
+    bool claim_rendezvous() noexcept {
+        return !(flags_.fetch_or(Claimed | SenderWaits, std::memory_order_acq_rel) & Claimed);
+    }
+
+    // Called once the result was taken. Costs one plain load unless the
+    // sender waits: it claimed with SenderWaits before publishing, so a reader
+    // that saw Ready also sees that bit.
+    void mark_taken() noexcept {
+        if (!(flags_.load(std::memory_order_relaxed) & SenderWaits)) return;
+        flags_.fetch_or(Taken, std::memory_order_acq_rel);
+        wake_sender();
+    }
+
+    bool taken() const noexcept { return flags_.load(std::memory_order_acquire) & Taken; }
+
+    // Waits until the result was taken or the receiver dropped; false on timeout.
+    bool wait_taken(const std::chrono::steady_clock::time_point* deadline) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        return wait_locked(lock, cv_, sender_node_, [this] {
+            return flags_.load(std::memory_order_acquire) & (Taken | ReceiverGone);
+        }, deadline);
+    }
+
+    // Makes the payload visible; only wakes if someone registered as a waiter.
+    void publish() {
+        if (flags_.fetch_or(Ready, std::memory_order_acq_rel) & Waiters) wake();
+    }
+
+    // Batch publication: the payload writes must already be ordered by a release
+    // fence. Returns true if wake_waiters() has to be called.
+    bool publish_relaxed() noexcept { return flags_.fetch_or(Ready, std::memory_order_relaxed) & Waiters; }
+
+    void wake_waiters() { wake(); }
+
+    bool is_ready() const noexcept { return flags_.load(std::memory_order_acquire) & Ready; }
+
+    void wait() {
+        if (is_ready()) return;
+        if (Parker* p = current_parker()) {
+            park_on(*p, nullptr);
+            return;
+        }
+        oneshot_blocking::check_wait([] { return false; });
+        std::unique_lock<std::mutex> lock(mtx_);
+        flags_.fetch_or(Waiters, std::memory_order_acq_rel);
+        while (!is_ready()) cv_.wait(lock);
+    }
+
+    // Returns true if the core is ready, false on timeout.
+    bool wait_until(std::chrono::steady_clock::time_point deadline) {
+        if (is_ready()) return true;
+        if (Parker* p = current_parker()) {
+            park_on(*p, &deadline);
+            return is_ready();
+        }
+        if (oneshot_blocking::is_nonblocking_thread()) {
+            oneshot_blocking::check_timed_wait(deadline - std::chrono::steady_clock::now(), [] { return false; });
+        }
+        std::unique_lock<std::mutex> lock(mtx_);
+        flags_.fetch_or(Waiters, std::memory_order_acq_rel);
+        while (!is_ready()) {
+            if (cv_.wait_until(lock, deadline) == std::cv_status::timeout) return is_ready();
+        }
+        return true;
+    }
+
+    // Links `node`; returns false (and does not link) if already ready.
+    bool add_waiter(WaitNode& node) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (flags_.fetch_or(Waiters, std::memory_order_acq_rel) & Ready) return false;
+        node.prev = nullptr;
+        node.next = head_;
+        if (head_) head_->prev = &node;
+        head_ = &node;
+        node.linked = true;
+        return true;
+    }
+
+    // Unlinks `node` if still pending and returns true if it did. Once this
+    // returns, `notify` is not running and will not run for it.
+    bool remove_waiter(WaitNode& node) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (!node.linked) {
+            while (notifying_) cv_.wait(lock);
+            return false;
+        }
+        if (node.prev) node.prev->next = node.next;
+        else head_ = node.next;
+        if (node.next) node.next->prev = node.prev;
+        node.linked = false;
+        return true;
+    }
+
+private:
+    void wake_sender() noexcept {
+        std::lock_guard<std::mutex> lock(mtx_);
+        wake_slot(sender_node_, cv_);
+    }
+
+    void wake() {
+        WaitNode* list;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            list = std::exchange(head_, nullptr);
+            for (WaitNode* n = list; n; n = n->next) n->linked = false;
+            notifying_ = list != nullptr;
+        }
+        cv_.notify_all();
+        if (!list) return;
+        while (list) {
+            WaitNode* next = list->next;  // `notify` may destroy the node
+            list->notify(list);
+            list = next;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            notifying_ = false;
+        }
+        cv_.notify_all();
+    }
+
+    void park_on(Parker& p, const std::chrono::steady_clock::time_point* deadline) {
+        WaitNode node;
+        p.prepare(node);
+        if (!add_waiter(node)) return;
+        p.park(node, deadline);
+        remove_waiter(node);
+    }
+};
+
+//
+// Event count for multi-shot structures (see BoundedChannel.hpp): waiters
+// sleep until notified, notifiers pay one fence and one load while nobody
+// waits. Waiters re-check their condition after registering, so a notify that
+// follows a state change the waiter missed always reaches it. Each waiter
+// links a node from its own stack; threads block on a condition variable,
+// fibers park through the installed Parker. Notifications run under the
+// queue's lock.
+//
+class WaitQueue {
+    struct ThreadWait {
+        std::condition_variable cv;
+        bool notified = false;
+    };
+
+    std::mutex mtx_;
+    WaitNode* head_ = nullptr;
+    WaitNode* tail_ = nullptr;
+    std::atomic<std::size_t> waiting_{0};
+
+public:
+    // Sleeps until notified or `deadline` (if given) passes, unless `ready()`
+    // already holds once registered. Callers re-check their condition after.
+    template<typename Ready>
+    void wait(Ready&& ready, const std::chrono::steady_clock::time_point* deadline) {
+        Parker* p = current_parker();
+        if (!p) {
+            if (!deadline) oneshot_blocking::check_wait(ready);
+            else oneshot_blocking::check_timed_wait(*deadline - std::chrono::steady_clock::now(), ready);
+        }
+        WaitNode node;
+        ThreadWait tw;
+        if (p) {
+            p->prepare(node);
+        } else {
+            node.notify = &notify_thread;
+            node.ctx = &tw;
+        }
+
+        std::unique_lock<std::mutex> lock(mtx_);
+        waiting_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ready()) {
+            waiting_.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        link(node);
+        if (p) {
+            lock.unlock();
+            p->park(node, deadline);
+            lock.lock();
+        } else {
+            while (!tw.notified) {
+                if (!deadline) tw.cv.wait(lock);
+                else if (tw.cv.wait_until(lock, *deadline) == std::cv_status::timeout) break;
+            }
+        }
+        if (node.linked) unlink(node);
+        waiting_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Wakes up to `n` waiters, oldest first. Must follow the state change it
+    // announces.
+    void notify(std::size_t n = 1) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_relaxed) == 0) return;
+        std::lock_guard<std::mutex> lock(mtx_);
+        while (n-- && head_) {
+            WaitNode* w = head_;
+            unlink(*w);
+            w->notify(w);
+        }
+    }
+
+    void notify_all() { notify(static_cast<std::size_t>(-1)); }
+
+private:
+    static void notify_thread(WaitNode* n) noexcept {
+        auto* tw = static_cast<ThreadWait*>(n->ctx);
+        tw->notified = true;
+        tw->cv.notify_one();
+    }
+
+    void link(WaitNode& n) noexcept {
+        n.prev = tail_;
+        n.next = nullptr;
+        if (tail_) tail_->next = &n;
+        else head_ = &n;
+        tail_ = &n;
+        n.linked = true;
+    }
+
+    void unlink(WaitNode& n) noexcept {
+        if (n.prev) n.prev->next = n.next;
+        else head_ = n.next;
+        if (n.next) n.next->prev = n.prev;
+        else tail_ = n.prev;
+        n.linked = false;
+    }
+};
+
+} // namespace oneshot_detail
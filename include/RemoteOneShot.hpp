@@ -0,0 +1,393 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+#pragma once
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <limits>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "OneShotFuture.hpp"
+
+//
+// Remote one-shot over a local stream socket (Unix domain socket / socketpair).
+//
+// The local process owns a RemoteOneShotEndpoint on one end of the socket. make<T>()
+// returns a RemoteToken plus an ordinary OneShot<T>::Receiver. The token is shipped
+// to another process by any means, where a RemoteOneShotCompleter on the other end
+// of the socket turns it back into a RemoteOneShotCompleter::Sender<T>. Completions are queued and
+// written together by flush(), so a batch of replies costs one syscall; the
+// endpoint's reader thread parses every frame of each read and completes the
+// matching local Receivers.
+//
+// Payloads are encoded with OneShotCodec<T> (or any codec with the same static
+// interface). Exceptions travel as their what() text and are rethrown locally as
+// RemoteOneShotError. If the connection drops, every pending Receiver observes
+// broken_promise.
+//
+
+//
+// Pluggable serialization. Specialize for your own types, or pass a codec type
+// with the same two static members as the second template argument.
+//
+template<typename T, typename Enable = void>
+struct OneShotCodec;
+
+template<typename T>
+struct OneShotCodec<T, std::enable_if_t<std::is_trivially_copyable<T>::value>> {
+    static void encode(const T& value, std::string& out) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    static T decode(const char* data, std::size_t len) {
+        if (len != sizeof(T)) throw std::length_error("OneShotCodec: payload size mismatch");
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+};
+
+template<>
+struct OneShotCodec<std::string> {
+    static void encode(const std::string& value, std::string& out) { out.append(value); }
+    static std::string decode(const char* data, std::size_t len) { return std::string(data, len); }
+};
+
+// Thrown by a Receiver whose remote Sender called set_exception.
+class RemoteOneShotError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Opaque handle for one pending remote completion on a given connection.
+struct RemoteToken {
+    std::uint64_t id = 0;
+
+    std::string serialize() const {
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(id));
+        return std::string(buf, 16);
+    }
+
+    static RemoteToken parse(const std::string& s) {
+        if (s.size() != 16) throw std::invalid_argument("RemoteToken: malformed token");
+        return RemoteToken{std::stoull(s, nullptr, 16)};
+    }
+};
+
+namespace remote_oneshot_detail {
+
+enum Kind : std::uint8_t { Value, Error, Broken };
+
+struct FrameHeader {
+    std::uint64_t id;
+    std::uint32_t len;
+    std::uint8_t kind;
+    std::uint8_t pad[3];
+};
+static_assert(sizeof(FrameHeader) == 16, "unexpected frame header padding");
+
+constexpr std::size_t max_payload = std::numeric_limits<std::uint32_t>::max();
+
+// Throws std::length_error, leaving `out` untouched, if the payload does not fit the header.
+inline void append_frame(std::string& out, std::uint64_t id, Kind kind, const char* data, std::size_t len) {
+    if (len > max_payload) throw std::length_error("RemoteOneShot: payload too large");
+    FrameHeader h{};
+    h.id = id;
+    h.len = static_cast<std::uint32_t>(len);
+    h.kind = kind;
+    out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+    if (len) out.append(data, len);
+}
+
+struct Pending {
+    virtual ~Pending() = default;  // dropping the OneShot sender breaks the promise
+    virtual void complete(Kind kind, const char* data, std::size_t len) = 0;
+};
+
+template<typename T, typename Codec>
+struct PendingOf : Pending {
+    typename OneShot<T>::Sender sender;
+
+    explicit PendingOf(typename OneShot<T>::Sender s) : sender(std::move(s)) {}
+
+    void complete(Kind kind, const char* data, std::size_t len) override {
+        if (kind == Error) {
+            sender.set_exception(std::make_exception_ptr(RemoteOneShotError(std::string(data, len))));
+            return;
+        }
+        if (kind != Value) return;  // Broken: destructor reports it
+        try {
+            deliver(data, len);
+        } catch (...) {
+            sender.set_exception(std::current_exception());
+        }
+    }
+
+private:
+    template<typename U = T>
+    std::enable_if_t<!std::is_void<U>::value> deliver(const char* data, std::size_t len) {
+        sender.set_value(Codec::decode(data, len));
+    }
+    template<typename U = T>
+    std::enable_if_t<std::is_void<U>::value> deliver(const char*, std::size_t) {
+        sender.set_value();
+    }
+};
+
+} // namespace remote_oneshot_detail
+
+//
+// Local side: issues tokens and completes Receivers from frames read off the socket.
+//
+class RemoteOneShotEndpoint {
+public:
+    // Takes ownership of `fd`, a connected stream socket.
+    explicit RemoteOneShotEndpoint(int fd) : fd_(fd) {
+        reader_ = std::thread([this]() { run(); });
+    }
+
+    RemoteOneShotEndpoint(const RemoteOneShotEndpoint&) = delete;
+    RemoteOneShotEndpoint& operator=(const RemoteOneShotEndpoint&) = delete;
+
+    ~RemoteOneShotEndpoint() {
+        ::shutdown(fd_, SHUT_RDWR);
+        reader_.join();
+        ::close(fd_);
+    }
+
+    template<typename T, typename Codec = OneShotCodec<T>>
+    std::pair<RemoteToken, typename OneShot<T>::Receiver> make() {
+        auto [s, r] = OneShot<T>::make();
+        std::unique_ptr<remote_oneshot_detail::Pending> p(
+            new remote_oneshot_detail::PendingOf<T, Codec>(std::move(s)));
+        std::uint64_t id;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            id = ++next_id_;
+            if (closed_) return {RemoteToken{id}, std::move(r)};  // p is dropped: broken promise
+            pending_.emplace(id, std::move(p));
+        }
+        return {RemoteToken{id}, std::move(r)};
+    }
+
+    // Number of tokens issued but not yet completed.
+    std::size_t pending() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return pending_.size();
+    }
+
+    bool connected() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return !closed_;
+    }
+
+private:
+    using Header = remote_oneshot_detail::FrameHeader;
+
+    int fd_;
+    std::thread reader_;
+    mutable std::mutex mtx_;
+    std::uint64_t next_id_ = 0;
+    bool closed_ = false;
+    std::unordered_map<std::uint64_t, std::unique_ptr<remote_oneshot_detail::Pending>> pending_;
+
+    void run() {
+        std::string buf;
+        char chunk[64 * 1024];
+        for (;;) {
+            ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            buf.append(chunk, static_cast<std::size_t>(n));
+            dispatch(buf);
+        }
+        disconnect();
+    }
+
+    // Completes every whole frame in `buf` and keeps the trailing partial frame.
+    void dispatch(std::string& buf) {
+        std::size_t off = 0;
+        while (buf.size() - off >= sizeof(Header)) {
+            Header h;
+            std::memcpy(&h, buf.data() + off, sizeof(h));
+            if (buf.size() - off - sizeof(h) < h.len) break;
+            const char* payload = buf.data() + off + sizeof(h);
+
+            std::unique_ptr<remote_oneshot_detail::Pending> p;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                auto it = pending_.find(h.id);
+                if (it != pending_.end()) {
+                    p = std::move(it->second);
+                    pending_.erase(it);
+                }
+            }
+            if (p) p->complete(static_cast<remote_oneshot_detail::Kind>(h.kind), payload, h.len);
+            off += sizeof(h) + h.len;
+        }
+        buf.erase(0, off);
+    }
+
+    void disconnect() {
+        std::unordered_map<std::uint64_t, std::unique_ptr<remote_oneshot_detail::Pending>> orphaned;
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            closed_ = true;
+            orphaned.swap(pending_);
+        }
+        // orphaned senders are destroyed here, outside the lock: broken_promise
+    }
+};
+
+//
+// Remote side: queues completion frames and writes them in batches.
+//
+class RemoteOneShotCompleter {
+    struct Link {
+        int fd;
+        std::mutex mtx;
+        std::string out;
+        std::size_t queued = 0;
+
+        explicit Link(int f) : fd(f) {}
+        ~Link() {
+            flush();
+            ::close(fd);
+        }
+
+        void push(std::uint64_t id, remote_oneshot_detail::Kind kind, const char* data, std::size_t len) {
+            std::lock_guard<std::mutex> lock(mtx);
+            remote_oneshot_detail::append_frame(out, id, kind, data, len);
+            ++queued;
+        }
+
+        std::size_t flush() {
+            std::lock_guard<std::mutex> lock(mtx);
+            std::size_t off = 0;
+            while (off < out.size()) {
+                ssize_t n = ::send(fd, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;  // peer gone: its receivers are already broken
+                off += static_cast<std::size_t>(n);
+            }
+            out.clear();
+            return std::exchange(queued, 0);
+        }
+    };
+
+public:
+    //
+    // Sending half of a remote one-shot. Completing only queues a frame; it is
+    // written by the owning completer's next flush(). A value encoding to 4 GiB
+    // or more throws std::length_error and leaves the Sender unused.
+    //
+    template<typename T, typename Codec = OneShotCodec<T>>
+    class Sender {
+        std::shared_ptr<Link> link_;
+        std::uint64_t id_ = 0;
+        bool used_ = false;
+
+    public:
+        Sender() = default;
+        Sender(std::shared_ptr<Link> l, std::uint64_t id) : link_(std::move(l)), id_(id) {}
+
+        Sender(Sender&& other) noexcept
+            : link_(std::move(other.link_)), id_(other.id_), used_(other.used_) {}
+        Sender& operator=(Sender&& other) noexcept {
+            if (this != &other) {
+                abandon();
+                link_ = std::move(other.link_);
+                id_ = other.id_;
+                used_ = other.used_;
+            }
+            return *this;
+        }
+        Sender(const Sender&) = delete;
+        Sender& operator=(const Sender&) = delete;
+
+        ~Sender() { abandon(); }
+
+        template<typename U = T>
+        std::enable_if_t<!std::is_void<U>::value, bool> set_value(const U& value) {
+            if (!link_ || used_) return false;
+            std::string payload;
+            Codec::encode(value, payload);
+            link_->push(id_, remote_oneshot_detail::Value, payload.data(), payload.size());
+            used_ = true;
+            return true;
+        }
+
+        template<typename U = T>
+        std::enable_if_t<std::is_void<U>::value, bool> set_value() {
+            if (!link_ || used_) return false;
+            used_ = true;
+            link_->push(id_, remote_oneshot_detail::Value, nullptr, 0);
+            return true;
+        }
+
+        bool set_exception(std::exception_ptr e) {
+            if (!link_ || used_) return false;
+            std::string what = "remote exception";
+            try {
+                std::rethrow_exception(e);
+            } catch (const std::exception& ex) {
+                what = ex.what();
+            } catch (...) {
+            }
+            if (what.size() > remote_oneshot_detail::max_payload) what.resize(remote_oneshot_detail::max_payload);
+            used_ = true;
+            link_->push(id_, remote_oneshot_detail::Error, what.data(), what.size());
+            return true;
+        }
+
+        explicit operator bool() const noexcept { return (bool)link_; }
+
+    private:
+        void abandon() noexcept {
+            if (link_ && !used_) {
+                used_ = true;
+                try {
+                    link_->push(id_, remote_oneshot_detail::Broken, nullptr, 0);
+                } catch (...) {}
+            }
+        }
+    };
+
+    // Takes ownership of `fd`, the peer end of the endpoint's socket.
+    explicit RemoteOneShotCompleter(int fd) : link_(std::make_shared<Link>(fd)) {}
+
+    RemoteOneShotCompleter(const RemoteOneShotCompleter&) = delete;
+    RemoteOneShotCompleter& operator=(const RemoteOneShotCompleter&) = delete;
+
+    // Flushes what is queued. The socket closes once the completer and every
+    // Sender attached through it are gone.
+    ~RemoteOneShotCompleter() { link_->flush(); }
+
+    template<typename T, typename Codec = OneShotCodec<T>>
+    Sender<T, Codec> attach(const RemoteToken& token) {
+        return Sender<T, Codec>{link_, token.id};
+    }
+
+    // Writes every queued completion; returns how many were written.
+    std::size_t flush() { return link_->flush(); }
+
+private:
+    std::shared_ptr<Link> link_;
+};
@@ -0,0 +1,35 @@
+/**
+ * Copyright @ 2024 Michel Hoche-Mong
+ * SPDX-License-Identifier: CC-BY-4.0
+ */
+
+//
+// C++20 module interface for the core one-shot types. Importers parse the
+// headers (and <memory>, <mutex>, ...) once, when this module is built,
+// instead of in every translation unit:
+//
+//   import oneshot;
+//   auto [s, r] = OneShot<int>::make();
+//
+// Built by CMake with -DONESHOT_BUILD_MODULE=ON (CMake >= 3.28, and a compiler
+// it can scan modules with: Clang 16, GCC 14, MSVC 17.4 or newer).
+//
+module;
+
+#include "OneShotFuture.hpp"
+#include "OneShotChannel.hpp"
+
+export module oneshot;
+
+export using ::OneShot;
+export using ::OneShotChannel;
+export using ::OneShotChannelStats;
+export using ::RendezvousResult;
+export using ::NullObserver;
+export using ::LatencyObserver;
+
+// layout policies for OneShotChannel's third parameter
+export namespace oneshot_layout {
+using ::oneshot_layout::Packed;
+using ::oneshot_layout::CacheAligned;
+} // namespace oneshot_layout
@@ -0,0 +1,92 @@
+#include "alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+//
+// Replacement global allocation functions that count per thread.
+//
+namespace {
+
+thread_local alloc_counter::Counts counts;
+
+void* allocate(std::size_t size) {
+    if (size == 0) size = 1;
+    void* p = std::malloc(size);
+    if (!p) return nullptr;
+    ++counts.allocations;
+    counts.bytes += size;
+    return p;
+}
+
+void* allocate(std::size_t size, std::align_val_t al) {
+    auto align = static_cast<std::size_t>(al);
+    if (align < sizeof(void*)) align = sizeof(void*);
+    if (size == 0) size = 1;
+#if defined(_WIN32)
+    void* p = _aligned_malloc(size, align);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, align, size) != 0) p = nullptr;
+#endif
+    if (!p) return nullptr;
+    ++counts.allocations;
+    counts.bytes += size;
+    return p;
+}
+
+void release(void* p) noexcept {
+    if (!p) return;
+    ++counts.deallocations;
+    std::free(p);
+}
+
+void release(void* p, std::align_val_t) noexcept {
+    if (!p) return;
+    ++counts.deallocations;
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+alloc_counter::Counts alloc_counter::thread_counts() noexcept { return counts; }
+
+void* operator new(std::size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t al) {
+    if (void* p = allocate(size, al)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+    if (void* p = allocate(size, al)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return allocate(size, al); }
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocate(size, al);
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t al) noexcept { release(p, al); }
+void operator delete[](void* p, std::align_val_t al) noexcept { release(p, al); }
+void operator delete(void* p, std::size_t, std::align_val_t al) noexcept { release(p, al); }
+void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept { release(p, al); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept { release(p, al); }
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept { release(p, al); }
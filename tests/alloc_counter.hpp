@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+//
+// Allocation accounting for tests and benchmarks. alloc_counter.cpp replaces
+// the global operator new/delete family and counts calls per thread; link it
+// into the executable to enable the counters.
+//
+//   EXPECT_ALLOCATIONS(0, { s.set_value(1); r.get(); });
+//
+namespace alloc_counter {
+
+struct Counts {
+    std::uint64_t allocations = 0;
+    std::uint64_t deallocations = 0;
+    std::uint64_t bytes = 0;  // requested by allocations
+};
+
+// Counts for the calling thread since it started.
+Counts thread_counts() noexcept;
+
+// Number of operator new calls `f()` makes on this thread.
+template<typename F>
+std::uint64_t count_allocations(F&& f) {
+    auto before = thread_counts().allocations;
+    f();
+    return thread_counts().allocations - before;
+}
+
+} // namespace alloc_counter
+
+// Expects the statements (a braced block) to call operator new exactly `n`
+// times on this thread. `n` is evaluated first and is not counted.
+#define EXPECT_ALLOCATIONS(n, ...)                                                          \
+    do {                                                                                     \
+        const auto alloc_counter_expected_ = static_cast<std::uint64_t>(n);                  \
+        const auto alloc_counter_before_ = ::alloc_counter::thread_counts().allocations;    \
+        __VA_ARGS__                                                                          \
+        EXPECT_EQ(::alloc_counter::thread_counts().allocations - alloc_counter_before_,      \
+                  alloc_counter_expected_)                                                   \
+            << "allocations in: " #__VA_ARGS__;                                              \
+    } while (0)
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "alloc_counter.hpp"
+#include "OneShotFuture.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotSelect.hpp"
+#include "BoundedChannel.hpp"
+#include "OneShotPool.hpp"
+#include "LocalThreadOneShot.hpp"
+#include "Exchanger.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// What the standard library spends on pieces the one-shots build on, so the
+// budgets below hold for any implementation.
+std::uint64_t broken_promise_allocations() {
+    return alloc_counter::count_allocations(
+        [] { std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)); });
+}
+
+} // namespace
+
+// --------------------------------------------------
+// Allocation budgets: OneShot
+// --------------------------------------------------
+
+TEST(OneShotAllocationTest, MakeIsOneAllocation) {
+    std::pair<OneShot<int>::Sender, OneShot<int>::Receiver> p;
+    EXPECT_ALLOCATIONS(1, { p = OneShot<int>::make(); });
+
+    std::pair<OneShot<void>::Sender, OneShot<void>::Receiver> v;
+    EXPECT_ALLOCATIONS(1, { v = OneShot<void>::make(); });
+}
+
+TEST(OneShotAllocationTest, SetAndGetDoNotAllocate) {
+    auto [s, r] = OneShot<int>::make();
+    EXPECT_ALLOCATIONS(0, {
+        s.set_value(1);
+        EXPECT_EQ(r.get(), 1);
+    });
+
+    auto [vs, vr] = OneShot<void>::make();
+    EXPECT_ALLOCATIONS(0, {
+        vs.set_value();
+        vr.get();
+    });
+}
+
+TEST(OneShotAllocationTest, TimedGetDoesNotAllocate) {
+    auto [s, r] = OneShot<int>::make();
+    EXPECT_ALLOCATIONS(0, { EXPECT_FALSE(r.get_for(1ms).has_value()); });
+    s.set_value(2);
+    EXPECT_ALLOCATIONS(0, { EXPECT_EQ(r.get_for(1ms), std::optional<int>(2)); });
+}
+
+TEST(OneShotAllocationTest, BrokenOnlyAllocatesTheException) {
+    const auto budget = broken_promise_allocations();
+    auto [s, r] = OneShot<int>::make();
+    EXPECT_ALLOCATIONS(budget, { s = {}; });
+    EXPECT_ALLOCATIONS(0, { EXPECT_THROW(r.get(), std::future_error); });
+}
+
+TEST(OneShotAllocationTest, TrySetValueToADroppedReceiverAllocatesNothing) {
+    // the value comes back, and the sender is complete: no broken_promise on drop
+    auto [s, r] = OneShot<int>::make();
+    r = {};
+    EXPECT_ALLOCATIONS(0, {
+        EXPECT_EQ(s.try_set_value(1), std::optional<int>(1));
+        s = {};
+    });
+}
+
+TEST(OneShotAllocationTest, OnlyAPendingForwardAllocatesItsLink) {
+    auto [down_s, down_r] = OneShot<int>::make();
+    auto [up_s, up_r] = OneShot<int>::make();
+    EXPECT_ALLOCATIONS(1, { OneShot<int>::forward(std::move(down_r), std::move(up_s)); });
+    EXPECT_ALLOCATIONS(0, { down_s.set_value(1); });
+    EXPECT_EQ(up_r.get(), 1);
+
+    auto [done_s, done_r] = OneShot<int>::make();
+    auto [next_s, next_r] = OneShot<int>::make();
+    done_s.set_value(2);
+    EXPECT_ALLOCATIONS(0, { next_s.set_from(std::move(done_r)); });
+    EXPECT_EQ(next_r.get(), 2);
+}
+
+// --------------------------------------------------
+// Allocation budgets: OneShotChannel
+// --------------------------------------------------
+
+TEST(OneShotChannelAllocationTest, MakeIsOneAllocation) {
+    std::pair<OneShotChannel<int>::Sender, OneShotChannel<int>::Receiver> p;
+    EXPECT_ALLOCATIONS(1, { p = OneShotChannel<int>::make(); });
+
+    std::pair<OneShotChannel<void>::Sender, OneShotChannel<void>::Receiver> v;
+    EXPECT_ALLOCATIONS(1, { v = OneShotChannel<void>::make(); });
+}
+
+TEST(OneShotChannelAllocationTest, SetAndGetDoNotAllocate) {
+    auto [s, r] = OneShotChannel<int>::make();
+    EXPECT_ALLOCATIONS(0, {
+        s.set_value(1);
+        EXPECT_EQ(r.get(), 1);
+        EXPECT_EQ(r.get_for(1ms), std::optional<int>(1));
+    });
+
+    auto [vs, vr] = OneShotChannel<void>::make();
+    EXPECT_ALLOCATIONS(0, {
+        vs.set_value();
+        vr.get();
+    });
+}
+
+TEST(OneShotChannelAllocationTest, ResetDoesNotAllocate) {
+    auto [s, r] = OneShotChannel<int>::make();
+    s.set_value(1);
+    EXPECT_ALLOCATIONS(0, { s.reset(); });
+    EXPECT_ALLOCATIONS(0, { s.reset(); });  // while pending
+
+    auto [vs, vr] = OneShotChannel<void>::make();
+    vs.set_value();
+    EXPECT_ALLOCATIONS(0, { vr.reset(); });
+}
+
+TEST(OneShotChannelAllocationTest, SteadyStateDoesNotAllocate) {
+    auto [s, r] = OneShotChannel<int>::make();
+    EXPECT_ALLOCATIONS(0, {
+        for (int i = 0; i < 16; ++i) {
+            s.set_value(i);
+            r.get();
+            r.reset();
+        }
+    });
+}
+
+TEST(OneShotChannelAllocationTest, BrokenDoesNotAllocate) {
+    // unlike OneShot, the channel raises broken_promise when it is read
+    auto [s, r] = OneShotChannel<int>::make();
+    EXPECT_ALLOCATIONS(0, { s = {}; });
+    EXPECT_ALLOCATIONS(0, { EXPECT_FALSE(r.get_for(1ms).has_value()); });
+}
+
+// --------------------------------------------------
+// Allocation budgets: select
+// --------------------------------------------------
+
+TEST(OneShotSelectAllocationTest, WaitingAndTimingOutDoNotAllocate) {
+    using namespace oneshot_select;
+    auto [rs, rr] = OneShot<int>::make();
+    auto [cs, cr] = OneShotChannel<void>::make();
+    EXPECT_ALLOCATIONS(0, { select(case_(rr, [](int) {}), case_(cr, [] {}), timeout(1ms, [] {})); });
+    EXPECT_ALLOCATIONS(0, { select(case_(rr, [](int) {}), case_(cr, [] {}), default_([] {})); });
+    cs.set_value();
+    EXPECT_ALLOCATIONS(0, { select(case_(rr, [](int) {}), case_(cr, [] {})); });
+}
+
+// --------------------------------------------------
+// Allocation budgets: Channel
+// --------------------------------------------------
+
+TEST(BoundedChannelAllocationTest, MakeIsStateAndRing) {
+    EXPECT_ALLOCATIONS(2, { auto ch = Channel<int>::make(16); });
+}
+
+TEST(BoundedChannelAllocationTest, SendAndReceiveDoNotAllocate) {
+    auto [tx, rx] = Channel<int>::make(16);
+    EXPECT_ALLOCATIONS(0, {
+        for (int i = 0; i < 64; ++i) {
+            tx.send(i);
+            rx.receive();
+        }
+        EXPECT_FALSE(rx.receive_for(1ms).has_value());
+    });
+}
+
+// --------------------------------------------------
+// Allocation budgets: pooled payloads
+// --------------------------------------------------
+
+TEST(OneShotPoolAllocationTest, WarmPoolHandoffAllocatesOnlyTheOneShot) {
+    oneshot_pool::Pool<std::vector<char>> pool;
+    pool.reserve(1, std::size_t(1) << 20);
+    EXPECT_ALLOCATIONS(1, {  // the OneShot state; the buffer comes back to the pool
+        auto [s, r] = OneShot<oneshot_pool::Pooled<std::vector<char>>>::make();
+        s.set_value(pool.acquire());
+        r.get();
+    });
+}
+
+TEST(OneShotPoolAllocationTest, WarmPoolThroughChannelAllocatesNothing) {
+    oneshot_pool::Pool<std::vector<char>> pool;
+    pool.reserve(2, std::size_t(1) << 20);
+    auto [tx, rx] = Channel<oneshot_pool::Pooled<std::vector<char>>>::make(4);
+    EXPECT_ALLOCATIONS(0, {
+        for (int i = 0; i < 64; ++i) {
+            tx.send(pool.acquire());
+            rx.receive();
+        }
+    });
+    EXPECT_EQ(pool.stats().created, 2u);
+}
+
+// --------------------------------------------------
+// Allocation budgets: LocalThreadOneShot
+// --------------------------------------------------
+
+TEST(LocalThreadOneShotAllocationTest, MakeIsTheOnlyAllocation) {
+    std::pair<LocalThreadOneShot<int>::Sender, LocalThreadOneShot<int>::Receiver> p;
+    EXPECT_ALLOCATIONS(1, { p = LocalThreadOneShot<int>::make(); });
+
+    auto& [s, r] = p;
+    int got = 0;
+    EXPECT_ALLOCATIONS(0, {
+        r.then([&got](LocalThreadOneShot<int>::Receiver done) { got = done.get(); });  // stored inline
+        s.set_value(5);
+    });
+    EXPECT_EQ(got, 5);
+}
+
+// --------------------------------------------------
+// Allocation budgets: Exchanger
+// --------------------------------------------------
+
+TEST(ExchangerAllocationTest, SwapsDoNotAllocate) {
+    Exchanger<int> ex;
+    std::thread other([&] {
+        EXPECT_ALLOCATIONS(0, {
+            for (int i = 0; i < 64; ++i) ex.exchange(i);
+        });
+    });
+    EXPECT_ALLOCATIONS(0, {
+        for (int i = 0; i < 64; ++i) ex.exchange(-i);
+    });
+    other.join();
+    int v = 0;
+    EXPECT_ALLOCATIONS(0, { EXPECT_FALSE(ex.exchange_for(v, 1ms)); });  // parks on the wait queue, then withdraws
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <string>
+#include <vector>
+#include "AsyncCache.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Not default constructible, and counts its calls.
+struct CountingHash {
+    std::size_t* calls;
+    explicit CountingHash(std::size_t* c) : calls(c) {}
+    std::size_t operator()(int k) const {
+        ++*calls;
+        return std::hash<int>{}(k);
+    }
+};
+
+} // namespace
+
+// --------------------------------------------------
+// AsyncCache<K, V> tests
+// --------------------------------------------------
+
+TEST(AsyncCacheTest, MissThenHit) {
+    AsyncCache<int, std::string> cache;
+
+    auto first = cache.acquire(1);
+    ASSERT_TRUE(first.sender);
+    EXPECT_FALSE(first.receiver.ready());
+    EXPECT_TRUE(first.sender.set_value("one"));
+    EXPECT_EQ(first.receiver.get(), "one");
+
+    auto second = cache.acquire(1);
+    EXPECT_FALSE(second.sender);
+    EXPECT_TRUE(second.receiver.ready());
+    EXPECT_EQ(second.receiver.get(), "one");
+}
+
+TEST(AsyncCacheTest, InFlightIsShared) {
+    AsyncCache<int, int> cache;
+
+    auto owner = cache.acquire(7);
+    auto waiter = cache.acquire(7);
+    ASSERT_TRUE(owner.sender);
+    EXPECT_FALSE(waiter.sender);
+
+    std::thread producer([s = std::move(owner.sender)]() mutable {
+        std::this_thread::sleep_for(30ms);
+        s.set_value(49);
+    });
+
+    EXPECT_EQ(waiter.receiver.get(), 49);
+    EXPECT_EQ(owner.receiver.get(), 49);
+    producer.join();
+}
+
+TEST(AsyncCacheTest, GetOrLoadRunsLoaderOnce) {
+    AsyncCache<int, int> cache;
+    std::atomic<int> loads{0};
+    constexpr int kThreads = 16;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&]() {
+            auto r = cache.get_or_load(3, [&](AsyncCache<int, int>::Sender s) {
+                loads.fetch_add(1);
+                std::this_thread::sleep_for(10ms);
+                s.set_value(9);
+            });
+            EXPECT_EQ(r.get(), 9);
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(loads.load(), 1);
+}
+
+TEST(AsyncCacheTest, ValueExpiresAfterTtl) {
+    AsyncCache<int, int>::Options opts;
+    opts.ttl = 20ms;
+    AsyncCache<int, int> cache(opts);
+
+    auto first = cache.acquire(1);
+    first.sender.set_value(1);
+    EXPECT_FALSE(cache.acquire(1).sender);
+
+    std::this_thread::sleep_for(40ms);
+    auto again = cache.acquire(1);
+    EXPECT_TRUE(again.sender);
+    EXPECT_FALSE(cache.find(2).has_value());
+}
+
+TEST(AsyncCacheTest, ExceptionIsCachedNegatively) {
+    AsyncCache<int, int>::Options opts;
+    opts.negative_ttl = 30ms;
+    AsyncCache<int, int> cache(opts);
+
+    auto first = cache.acquire(5);
+    first.sender.set_exception(std::make_exception_ptr(std::runtime_error("fail")));
+
+    auto cached = cache.acquire(5);
+    EXPECT_FALSE(cached.sender);
+    EXPECT_THROW(cached.receiver.get(), std::runtime_error);
+
+    std::this_thread::sleep_for(50ms);
+    EXPECT_TRUE(cache.acquire(5).sender);
+}
+
+TEST(AsyncCacheTest, BrokenPromiseIsNotCached) {
+    AsyncCache<int, int> cache;
+
+    auto first = cache.acquire(5);
+    first.sender = {};
+    EXPECT_THROW(first.receiver.get(), std::future_error);
+
+    auto retry = cache.acquire(5);
+    ASSERT_TRUE(retry.sender);
+    retry.sender.set_value(55);
+    EXPECT_EQ(retry.receiver.get(), 55);
+}
+
+TEST(AsyncCacheTest, LeastRecentlyUsedIsEvicted) {
+    AsyncCache<int, int>::Options opts;
+    opts.capacity = 2;
+    opts.shards = 1;
+    AsyncCache<int, int> cache(opts);
+
+    cache.acquire(1).sender.set_value(1);
+    cache.acquire(2).sender.set_value(2);
+    EXPECT_TRUE(cache.find(1).has_value());  // 1 is now most recent
+    cache.acquire(3).sender.set_value(3);
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.find(1).has_value());
+    EXPECT_FALSE(cache.find(2).has_value());
+    EXPECT_TRUE(cache.find(3).has_value());
+}
+
+TEST(AsyncCacheTest, PendingEntryIsNotEvicted) {
+    AsyncCache<int, int>::Options opts;
+    opts.capacity = 1;
+    opts.shards = 1;
+    AsyncCache<int, int> cache(opts);
+
+    auto pending = cache.acquire(1);
+    auto other = cache.acquire(2);
+    EXPECT_EQ(cache.size(), 2u);  // both loading: over capacity until one completes
+
+    auto again = cache.acquire(1);
+    EXPECT_FALSE(again.sender);  // joins the load in flight instead of starting another
+
+    other.sender.set_value(2);
+    cache.acquire(3);  // evicts the completed entry, not the pending one
+    EXPECT_TRUE(cache.find(1).has_value());
+    EXPECT_FALSE(cache.find(2).has_value());
+
+    pending.sender.set_value(10);
+    EXPECT_EQ(again.receiver.get(), 10);
+}
+
+TEST(AsyncCacheTest, UsesTheGivenHasher) {
+    std::size_t calls = 0;
+    AsyncCache<int, int, CountingHash> cache({}, CountingHash(&calls));
+
+    cache.acquire(1).sender.set_value(10);
+    EXPECT_GT(calls, 0u);
+    ASSERT_TRUE(cache.find(1).has_value());
+    EXPECT_EQ(cache.find(1)->get(), 10);
+}
@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <atomic>
+#include "BoundedChannel.hpp"
+
+using namespace std::chrono_literals;
+
+// --------------------------------------------------
+// Channel<T>: single thread
+// --------------------------------------------------
+
+TEST(BoundedChannelTest, FifoOrder) {
+    auto [tx, rx] = Channel<int>::make(8);
+    for (int i = 0; i < 8; ++i) EXPECT_TRUE(tx.send(i));
+    for (int i = 0; i < 8; ++i) EXPECT_EQ(rx.receive(), i);
+    EXPECT_FALSE(rx.try_receive().has_value());
+}
+
+TEST(BoundedChannelTest, CapacityIsRoundedUpToAPowerOfTwo) {
+    EXPECT_EQ(Channel<int>::make(0).first.capacity(), 2u);
+    EXPECT_EQ(Channel<int>::make(1).first.capacity(), 2u);
+    EXPECT_EQ(Channel<int>::make(5).second.capacity(), 8u);
+    EXPECT_EQ(Channel<int>::make(64).second.capacity(), 64u);
+}
+
+TEST(BoundedChannelTest, CapacityWithoutAPowerOfTwoIsRejected) {
+    // rounding up would overflow size_t
+    EXPECT_THROW(Channel<int>::make(SIZE_MAX), std::length_error);
+    EXPECT_THROW(Channel<int>::make((SIZE_MAX >> 1) + 2), std::length_error);
+}
+
+TEST(BoundedChannelTest, TrySendKeepsTheValueWhenFull) {
+    auto [tx, rx] = Channel<std::string>::make(2);
+    EXPECT_TRUE(tx.try_send("a"));
+    EXPECT_TRUE(tx.try_send("b"));
+    std::string c = "c";
+    EXPECT_FALSE(tx.try_send(std::move(c)));
+    EXPECT_EQ(c, "c");
+    EXPECT_EQ(rx.try_receive(), std::optional<std::string>("a"));
+    EXPECT_TRUE(tx.try_send(std::move(c)));
+    EXPECT_EQ(rx.receive(), "b");
+    EXPECT_EQ(rx.receive(), "c");
+}
+
+TEST(BoundedChannelTest, TimedOperationsTimeOut) {
+    auto [tx, rx] = Channel<int>::make(2);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(rx.receive_for(20ms).has_value());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+
+    EXPECT_TRUE(tx.send_for(1, 20ms));
+    EXPECT_TRUE(tx.send_for(2, 20ms));
+    int three = 3;
+    start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(tx.send_for(std::move(three), 20ms));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+    EXPECT_EQ(rx.receive_for(20ms), std::optional<int>(1));
+}
+
+TEST(BoundedChannelTest, UnreceivedValuesAreDestroyedWithTheChannel) {
+    auto tracked = std::make_shared<int>(0);
+    {
+        auto [tx, rx] = Channel<std::shared_ptr<int>>::make(4);
+        tx.send(tracked);
+        tx.send(tracked);
+        rx.receive();
+        EXPECT_EQ(tracked.use_count(), 2);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+// --------------------------------------------------
+// Close semantics
+// --------------------------------------------------
+
+TEST(BoundedChannelTest, DroppingTheLastSenderClosesAfterDraining) {
+    auto [tx, rx] = Channel<int>::make(4);
+    auto tx2 = tx;  // a second sender keeps it open
+    tx.send(1);
+    tx = {};
+    EXPECT_FALSE(rx.closed());
+    tx2.send(2);
+    tx2 = {};
+
+    EXPECT_FALSE(rx.closed());  // still holds values
+    EXPECT_EQ(rx.receive(), 1);
+    EXPECT_EQ(rx.receive_for(1s), std::optional<int>(2));
+    EXPECT_TRUE(rx.closed());
+    EXPECT_FALSE(rx.receive_for(1s).has_value());
+    try {
+        rx.receive();
+        FAIL() << "expected broken_promise";
+    } catch (const std::future_error& e) {
+        EXPECT_EQ(e.code(), std::make_error_code(std::future_errc::broken_promise));
+    }
+}
+
+TEST(BoundedChannelTest, CloseWakesBlockedReceivers) {
+    auto [tx, rx] = Channel<int>::make(4);
+    std::thread closer([&tx = tx]() {
+        std::this_thread::sleep_for(20ms);
+        tx.close();
+    });
+    EXPECT_THROW(rx.receive(), std::future_error);
+    closer.join();
+    EXPECT_TRUE(tx.closed());
+    EXPECT_FALSE(tx.send(1));
+}
+
+TEST(BoundedChannelTest, EverySuccessfulSendRacingCloseIsReceived) {
+    constexpr int kRounds = 2000;
+    for (int round = 0; round < kRounds; ++round) {
+        auto [tx, rx] = Channel<int>::make(8);
+        std::atomic<int> sent{0};
+        std::thread sender([&sent, tx = tx]() mutable {
+            for (int i = 0; i < 4; ++i) {
+                if (tx.send(i)) ++sent;
+            }
+        });
+        std::thread closer([tx = tx]() mutable { tx.close(); });
+        int received = 0;
+        while (rx.receive_for(1s)) ++received;  // empty only once closed and drained
+        sender.join();
+        closer.join();
+        ASSERT_EQ(received, sent.load()) << "round " << round;
+    }
+}
+
+TEST(BoundedChannelTest, SendFailsOnceEveryReceiverIsGone) {
+    auto [tx, rx] = Channel<int>::make(2);
+    tx.send(1);
+    tx.send(2);
+    std::thread dropper([rx = std::move(rx)]() mutable {
+        std::this_thread::sleep_for(20ms);
+        rx = {};
+    });
+    EXPECT_FALSE(tx.send(3));  // blocked while full, woken by the last receiver leaving
+    dropper.join();
+    EXPECT_TRUE(tx.closed());
+    EXPECT_FALSE(tx.try_send(4));
+}
+
+// --------------------------------------------------
+// Blocking and batches
+// --------------------------------------------------
+
+TEST(BoundedChannelTest, SendBlocksWhileFullAndReceiveWhileEmpty) {
+    auto [tx, rx] = Channel<int>::make(2);
+    std::thread consumer([&rx = rx]() {
+        std::this_thread::sleep_for(20ms);
+        for (int i = 0; i < 10; ++i) EXPECT_EQ(rx.receive(), i);
+    });
+    for (int i = 0; i < 10; ++i) EXPECT_TRUE(tx.send(i));
+    consumer.join();
+}
+
+TEST(BoundedChannelTest, BatchSendAndReceive) {
+    auto [tx, rx] = Channel<int>::make(4);
+    std::vector<int> in{0, 1, 2, 3, 4, 5};
+    EXPECT_EQ(tx.try_send_batch(in.data(), in.size()), 4u);
+
+    std::vector<int> out(8, -1);
+    EXPECT_EQ(rx.try_receive_batch(out.data(), 3), 3u);
+    EXPECT_EQ(rx.receive_batch(out.data() + 3, 5), 1u);
+    EXPECT_EQ(std::vector<int>(out.begin(), out.begin() + 4), (std::vector<int>{0, 1, 2, 3}));
+
+    std::thread consumer([&rx = rx]() {
+        std::vector<int> got;
+        int buf[3];
+        while (std::size_t n = rx.receive_batch(buf, 3)) got.insert(got.end(), buf, buf + n);
+        std::vector<int> expected(100);
+        for (int i = 0; i < 100; ++i) expected[i] = i;
+        EXPECT_EQ(got, expected);
+    });
+    std::vector<int> many(100);
+    for (int i = 0; i < 100; ++i) many[i] = i;
+    EXPECT_EQ(tx.send_batch(many.data(), many.size()), 100u);
+    tx.close();
+    consumer.join();
+}
+
+TEST(BoundedChannelTest, ManyProducersManyConsumers) {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kPerProducer = 5000;
+    auto [tx, rx] = Channel<int>::make(64);
+
+    std::atomic<long long> sum{0};
+    std::atomic<int> count{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&, rx = rx]() mutable {
+            for (;;) {
+                try {
+                    sum += rx.receive();
+                    ++count;
+                } catch (const std::future_error&) {
+                    return;
+                }
+            }
+        });
+    }
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p, tx = tx]() mutable {
+            for (int i = 0; i < kPerProducer; ++i) ASSERT_TRUE(tx.send(p * kPerProducer + i));
+        });
+    }
+    tx = {};  // the producers' copies close the channel as they finish
+    rx = {};
+    for (auto& t : threads) t.join();
+
+    constexpr long long n = kProducers * kPerProducer;
+    EXPECT_EQ(count.load(), n);
+    EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
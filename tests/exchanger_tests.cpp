@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Exchanger.hpp"
+
+using namespace std::chrono_literals;
+
+// --------------------------------------------------
+// Two parties
+// --------------------------------------------------
+
+TEST(ExchangerTest, SwapsValuesBetweenTwoThreads) {
+    Exchanger<std::string> ex;
+    std::string got;
+    std::thread other([&] { got = ex.exchange("from other"); });
+    EXPECT_EQ(ex.exchange("from main"), "from other");
+    other.join();
+    EXPECT_EQ(got, "from main");
+}
+
+TEST(ExchangerTest, StateFitsOneCacheLine) {
+    EXPECT_EQ(alignof(Exchanger<int>), oneshot_layout::cache_line);
+    EXPECT_GE(sizeof(Exchanger<int>), 2 * oneshot_layout::cache_line);  // round state, then the wait queue
+}
+
+TEST(ExchangerTest, MoveOnlyBuffersChangeHands) {
+    Exchanger<std::unique_ptr<std::vector<int>>> ex;
+    constexpr int kRounds = 1000;
+    std::thread drainer([&] {
+        auto buf = std::make_unique<std::vector<int>>();
+        for (int i = 0; i < kRounds; ++i) {
+            buf = ex.exchange(std::move(buf));
+            ASSERT_EQ(buf->size(), 1u);
+            EXPECT_EQ((*buf)[0], i);
+            buf->clear();
+        }
+    });
+    auto buf = std::make_unique<std::vector<int>>();
+    for (int i = 0; i < kRounds; ++i) {
+        buf->push_back(i);  // fill, then swap for the drained one
+        buf = ex.exchange(std::move(buf));
+        EXPECT_TRUE(buf->empty());
+    }
+    drainer.join();
+}
+
+// --------------------------------------------------
+// Timeouts
+// --------------------------------------------------
+
+TEST(ExchangerTest, TimeoutLeavesTheValueAndTheExchangerUsable) {
+    Exchanger<std::unique_ptr<int>> ex;
+    auto mine = std::make_unique<int>(1);
+    EXPECT_FALSE(ex.exchange_for(mine, 5ms));
+    ASSERT_TRUE(mine);
+    EXPECT_EQ(*mine, 1);
+
+    std::thread other([&] { EXPECT_EQ(*ex.exchange(std::make_unique<int>(2)), 1); });
+    EXPECT_TRUE(ex.exchange_for(mine, 10s));
+    EXPECT_EQ(*mine, 2);
+    other.join();
+}
+
+TEST(ExchangerTest, TimedAndUntimedSidesPair) {
+    Exchanger<int> ex;
+    for (int i = 0; i < 200; ++i) {
+        std::thread other([&] { EXPECT_EQ(ex.exchange(i), -i); });
+        int v = -i;
+        while (!ex.exchange_for(v, 1ms)) EXPECT_EQ(v, -i);  // racing the partner's arrival
+        EXPECT_EQ(v, i);
+        other.join();
+    }
+}
+
+// --------------------------------------------------
+// More than two parties
+// --------------------------------------------------
+
+TEST(ExchangerTest, ManyThreadsArePairedTwoAtATime) {
+    constexpr int kThreads = 8;
+    Exchanger<int> ex;
+    std::atomic<bool> stop{false};
+    std::atomic<long> swaps{0}, given{0}, received{0};
+    std::vector<std::thread> threads;
+    for (int t = 1; t <= kThreads; ++t) {
+        // partners are not spread evenly, so threads run until told to stop
+        threads.emplace_back([&, t] {
+            while (!stop.load()) {
+                int v = t;
+                if (!ex.exchange_for(v, 1ms)) continue;
+                EXPECT_NE(v, t);  // never paired with itself
+                swaps.fetch_add(1);
+                given.fetch_add(t);
+                received.fetch_add(v);
+            }
+        });
+    }
+    while (swaps.load() < 4000) std::this_thread::sleep_for(1ms);
+    stop = true;
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(swaps.load() % 2, 0);
+    EXPECT_EQ(given.load(), received.load());  // every value handed over exactly once
+}
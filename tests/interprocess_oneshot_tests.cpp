@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <system_error>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "InterprocessOneShot.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Reply {
+    int id;
+    double value;
+};
+
+// Runs `fn` in a forked child that exits without unwinding back into gtest.
+template<typename F>
+pid_t fork_child(F&& fn) {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        fn();
+        ::_exit(0);
+    }
+    return pid;
+}
+
+int wait_child(pid_t pid) {
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    return status;
+}
+
+} // namespace
+
+// --------------------------------------------------
+// InterprocessOneShot<T> tests
+// --------------------------------------------------
+
+TEST(InterprocessOneShotTest, ValueAcrossFork) {
+    auto channel = InterprocessOneShot<Reply>::create();
+    auto r = channel.receiver();
+
+    pid_t pid = fork_child([&]() {
+        auto s = channel.sender();
+        std::this_thread::sleep_for(30ms);
+        s.set_value(Reply{7, 3.5});
+    });
+
+    Reply got = r.get();
+    EXPECT_EQ(got.id, 7);
+    EXPECT_DOUBLE_EQ(got.value, 3.5);
+    EXPECT_EQ(wait_child(pid), 0);
+}
+
+TEST(InterprocessOneShotTest, ReceiverWaitsForLateAttach) {
+    auto channel = InterprocessOneShot<int>::create();
+    auto r = channel.receiver();
+
+    pid_t pid = fork_child([&]() {
+        std::this_thread::sleep_for(50ms);
+        auto s = channel.sender();
+        s.set_value(11);
+    });
+
+    EXPECT_FALSE(r.get_for(10ms).has_value());
+    EXPECT_EQ(r.get(), 11);
+    wait_child(pid);
+}
+
+TEST(InterprocessOneShotTest, CrashedSenderIsBrokenPromise) {
+    auto channel = InterprocessOneShot<int>::create();
+    auto r = channel.receiver();
+
+    pid_t pid = fork_child([&]() {
+        auto s = channel.sender();
+        std::this_thread::sleep_for(20ms);
+        ::_exit(3);  // dies holding the Sender, no destructor runs
+    });
+
+    try {
+        r.get();
+        FAIL() << "expected broken_promise";
+    } catch (const std::future_error& e) {
+        EXPECT_EQ(e.code(), std::make_error_code(std::future_errc::broken_promise));
+    }
+    wait_child(pid);
+}
+
+TEST(InterprocessOneShotTest, DroppedSenderIsBrokenPromise) {
+    auto channel = InterprocessOneShot<int>::create();
+    auto r = channel.receiver();
+    {
+        auto s = channel.sender();
+    }
+    EXPECT_TRUE(r.ready());
+    EXPECT_THROW(r.get(), std::future_error);
+}
+
+TEST(InterprocessOneShotTest, ErrorCodePropagation) {
+    auto channel = InterprocessOneShot<int>::create();
+    auto r = channel.receiver();
+
+    pid_t pid = fork_child([&]() {
+        auto s = channel.sender();
+        s.set_error(ECONNRESET);
+    });
+
+    try {
+        r.get();
+        FAIL() << "expected system_error";
+    } catch (const std::system_error& e) {
+        EXPECT_EQ(e.code().value(), ECONNRESET);
+    }
+    wait_child(pid);
+}
+
+TEST(InterprocessOneShotTest, AttachByDescriptor) {
+    auto channel = InterprocessOneShot<int>::create();
+    auto other = InterprocessOneShot<int>::attach(channel.fd());
+
+    auto s = other.sender();
+    auto r = channel.receiver();
+    EXPECT_FALSE(r.ready());
+    EXPECT_TRUE(s.set_value(5));
+    EXPECT_FALSE(s.set_value(6));
+    EXPECT_EQ(r.get(), 5);
+    EXPECT_THROW(channel.sender(), std::future_error);
+}
+
+TEST(InterprocessOneShotTest, TimedWaitWhileAttached) {
+    auto channel = InterprocessOneShot<int>::create();
+    auto r = channel.receiver();
+
+    pid_t pid = fork_child([&]() {
+        auto s = channel.sender();
+        std::this_thread::sleep_for(100ms);
+        s.set_value(1);
+    });
+
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(r.wait_for(20ms));
+    EXPECT_EQ(r.get_for(1s), std::optional<int>(1));
+    wait_child(pid);
+}
+
+TEST(InterprocessOneShotTest, SenderMovesWithinItsThread) {
+    auto channel = InterprocessOneShot<int>::create();
+    auto r = channel.receiver();
+    InterprocessOneShot<int>::Sender s;
+    s = channel.sender();
+    InterprocessOneShot<int>::Sender moved = std::move(s);
+    EXPECT_TRUE(moved.set_value(3));
+    EXPECT_EQ(r.get(), 3);
+}
+
+TEST(InterprocessOneShotDeathTest, SenderUsedFromAnotherThreadAborts) {
+    // the robust mutex belongs to the attaching thread; another one could not unlock it
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_DEATH(
+        {
+            auto channel = InterprocessOneShot<int>::create();
+            auto s = channel.sender();
+            std::thread([s = std::move(s)]() mutable { s.set_value(1); }).join();
+        },
+        "other than the one that attached it");
+}
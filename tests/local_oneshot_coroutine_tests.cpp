@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <coroutine>
+#include <exception>
+#include <future>
+#include "LocalThreadOneShot.hpp"
+
+namespace {
+
+// Eager, fire-and-forget coroutine (see oneshot_stream_tests.cpp).
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+} // namespace
+
+// --------------------------------------------------
+// co_await on LocalThreadOneShot
+// --------------------------------------------------
+
+TEST(LocalThreadOneShotCoroutineTest, SetValueResumesTheCoroutineInline) {
+    auto [s, r] = LocalThreadOneShot<int>::make();
+    int got = 0;
+    [](LocalThreadOneShot<int>::Receiver r, int& got) -> Task { got = co_await r; }(std::move(r), got);
+
+    EXPECT_EQ(got, 0);  // suspended
+    s.set_value(7);
+    EXPECT_EQ(got, 7);
+}
+
+TEST(LocalThreadOneShotCoroutineTest, ReadyResultDoesNotSuspend) {
+    auto [s, r] = LocalThreadOneShot<void>::make();
+    s.set_value();
+    bool done = false;
+    [](LocalThreadOneShot<void>::Receiver r, bool& done) -> Task {
+        co_await r;
+        done = true;
+    }(std::move(r), done);
+    EXPECT_TRUE(done);
+}
+
+TEST(LocalThreadOneShotCoroutineTest, BrokenPromiseIsRethrownFromCoAwait) {
+    auto [s, r] = LocalThreadOneShot<int>::make();
+    bool broken = false;
+    [](LocalThreadOneShot<int>::Receiver r, bool& broken) -> Task {
+        try {
+            co_await r;
+        } catch (const std::future_error&) {
+            broken = true;
+        }
+    }(std::move(r), broken);
+    s = {};
+    EXPECT_TRUE(broken);
+}
+
+TEST(LocalThreadOneShotCoroutineTest, DestroyedCoroutineIsNotResumed) {
+    struct Lazy {
+        struct promise_type {
+            Lazy get_return_object() noexcept { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+        std::coroutine_handle<promise_type> h;
+    };
+
+    auto [s, r] = LocalThreadOneShot<int>::make();
+    int got = 0;
+    Lazy task = [](LocalThreadOneShot<int>::Receiver& r, int& got) -> Lazy { got = co_await r; }(r, got);
+    task.h.destroy();
+    EXPECT_TRUE(s.set_value(1));
+    EXPECT_EQ(got, 0);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "LocalThreadOneShot.hpp"
+
+using oneshot_local::CheckedThread;
+using oneshot_local::Unchecked;
+
+// --------------------------------------------------
+// Results already there
+// --------------------------------------------------
+
+TEST(LocalThreadOneShotTest, GetAfterSet) {
+    auto [s, r] = LocalThreadOneShot<std::string>::make();
+    EXPECT_FALSE(r.ready());
+    EXPECT_TRUE(s.set_value("hello"));
+    EXPECT_FALSE(s.set_value("again"));
+    EXPECT_TRUE(r.ready());
+    EXPECT_EQ(r.get(), "hello");
+    EXPECT_FALSE(r);
+}
+
+TEST(LocalThreadOneShotTest, GetBeforeSetThrowsInsteadOfBlocking) {
+    auto [s, r] = LocalThreadOneShot<int>::make();
+    EXPECT_THROW(r.get(), std::logic_error);
+    s.set_value(1);
+    EXPECT_EQ(r.get(), 1);  // still usable
+}
+
+TEST(LocalThreadOneShotTest, ExceptionsAndBrokenPromise) {
+    auto [s, r] = LocalThreadOneShot<int>::make();
+    s.set_exception(std::make_exception_ptr(std::runtime_error("fail")));
+    EXPECT_THROW(r.get(), std::runtime_error);
+
+    auto [vs, vr] = LocalThreadOneShot<void>::make();
+    vs = {};
+    EXPECT_TRUE(vr.ready());
+    EXPECT_THROW(vr.get(), std::future_error);
+}
+
+// --------------------------------------------------
+// Continuations
+// --------------------------------------------------
+
+TEST(LocalThreadOneShotTest, ContinuationRunsInsideSetValue) {
+    auto [s, r] = LocalThreadOneShot<int>::make();
+    int got = 0;
+    r.then([&got](LocalThreadOneShot<int>::Receiver done) { got = done.get(); });
+    EXPECT_FALSE(r);  // consumed by then()
+    EXPECT_EQ(got, 0);
+    s.set_value(42);
+    EXPECT_EQ(got, 42);
+}
+
+TEST(LocalThreadOneShotTest, ContinuationOnReadyResultRunsRightAway) {
+    auto [s, r] = LocalThreadOneShot<void>::make();
+    s.set_value();
+    bool ran = false;
+    r.then([&ran](LocalThreadOneShot<void>::Receiver done) {
+        done.get();
+        ran = true;
+    });
+    EXPECT_TRUE(ran);
+}
+
+TEST(LocalThreadOneShotTest, DroppedSenderRunsContinuationWithBrokenPromise) {
+    auto [s, r] = LocalThreadOneShot<int>::make();
+    bool broken = false;
+    r.then([&broken](LocalThreadOneShot<int>::Receiver done) {
+        try {
+            done.get();
+        } catch (const std::future_error&) {
+            broken = true;
+        }
+    });
+    s = {};
+    EXPECT_TRUE(broken);
+}
+
+TEST(LocalThreadOneShotTest, LargeContinuationsAndChains) {
+    std::array<int, 16> big{};
+    big[15] = 5;
+    auto [s1, r1] = LocalThreadOneShot<int>::make();
+    auto [s2, r2] = LocalThreadOneShot<int>::make();
+    int result = 0;
+
+    // too big for the inline slot; forwards into the next one-shot
+    r1.then([big, s2 = std::move(s2)](LocalThreadOneShot<int>::Receiver done) mutable {
+        s2.set_value(done.get() + big[15]);
+    });
+    r2.then([&result](LocalThreadOneShot<int>::Receiver done) { result = done.get(); });
+    s1.set_value(1);
+    EXPECT_EQ(result, 6);
+}
+
+TEST(LocalThreadOneShotTest, ContinuationIsFreedOnceItRan) {
+    auto token = std::make_shared<int>(0);
+    {
+        auto [s, r] = LocalThreadOneShot<int, Unchecked>::make();
+        std::array<std::shared_ptr<int>, 4> copies{token, token, token, token};
+        r.then([copies = std::move(copies)](LocalThreadOneShot<int, Unchecked>::Receiver) {});
+        EXPECT_EQ(token.use_count(), 5);
+    }  // Sender dropped: the continuation runs with broken_promise, then is freed
+    EXPECT_EQ(token.use_count(), 1);
+}
+
+// --------------------------------------------------
+// Thread confinement
+// --------------------------------------------------
+
+TEST(LocalThreadOneShotDeathTest, CheckedThreadAbortsOnCrossThreadUse) {
+    using Checked = LocalThreadOneShot<int, CheckedThread>;
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_DEATH(
+        {
+            auto pair = Checked::make();
+            auto& s = pair.first;
+            std::thread([&s] { s.set_value(1); }).join();
+        },
+        "other than the one that made it");
+}
+
+TEST(LocalThreadOneShotTest, UncheckedPolicyHasNoState) {
+    EXPECT_TRUE(std::is_empty<Unchecked>::value);
+    auto pair = LocalThreadOneShot<int, Unchecked>::make();
+    auto& s = pair.first;
+    std::thread([&s] { s.set_value(3); }).join();  // unchecked: caller's responsibility
+    EXPECT_EQ(pair.second.get(), 3);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <string>
+#include "OneShotFuture.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotBlocking.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Marks the test thread for the duration of a test and restores the defaults.
+struct NonblockingScope {
+    NonblockingScope() { oneshot_blocking::mark_nonblocking_thread(); }
+    ~NonblockingScope() {
+        oneshot_blocking::mark_nonblocking_thread(false);
+        oneshot_blocking::set_action(oneshot_blocking::Action::Count);
+        oneshot_blocking::set_timed_wait_budget(0ns);
+    }
+};
+
+} // namespace
+
+// --------------------------------------------------
+// Blocking-wait detector tests
+// --------------------------------------------------
+
+TEST(OneShotBlockingTest, UnmarkedThreadsAreIgnored) {
+    auto before = oneshot_blocking::violations();
+    auto [s, r] = OneShot<int>::make();
+    std::thread producer([s = std::move(s)]() mutable {
+        std::this_thread::sleep_for(5ms);
+        s.set_value(1);
+    });
+    EXPECT_EQ(r.get(), 1);
+    producer.join();
+    EXPECT_EQ(oneshot_blocking::violations(), before);
+}
+
+TEST(OneShotBlockingTest, BlockingGetOnMarkedThreadIsCounted) {
+    NonblockingScope scope;
+    auto before = oneshot_blocking::violations();
+
+    auto [s, r] = OneShot<int>::make();
+    std::thread producer([s = std::move(s)]() mutable {
+        std::this_thread::sleep_for(5ms);
+        s.set_value(1);
+    });
+    EXPECT_EQ(r.get(), 1);
+    producer.join();
+    EXPECT_EQ(oneshot_blocking::violations(), before + 1);
+
+    // a ready result does not block
+    auto [s2, r2] = OneShot<void>::make();
+    s2.set_value();
+    r2.get();
+    EXPECT_EQ(oneshot_blocking::violations(), before + 1);
+}
+
+TEST(OneShotBlockingTest, TimedWaitsWithinBudgetAreAllowed) {
+    NonblockingScope scope;
+    oneshot_blocking::set_timed_wait_budget(5ms);
+    auto before = oneshot_blocking::violations();
+
+    auto [s, r] = OneShot<int>::make();
+    EXPECT_FALSE(r.get_for(1ms).has_value());
+    EXPECT_EQ(oneshot_blocking::violations(), before);
+    EXPECT_FALSE(r.get_for(20ms).has_value());
+    EXPECT_EQ(oneshot_blocking::violations(), before + 1);
+}
+
+TEST(OneShotBlockingTest, ChannelWaitsAreChecked) {
+    NonblockingScope scope;
+    auto before = oneshot_blocking::violations();
+
+    auto [s, r] = OneShotChannel<int>::make();
+    EXPECT_FALSE(r.get_for(1ms).has_value());
+    EXPECT_EQ(oneshot_blocking::violations(), before + 1);
+
+    s.set_value(3);
+    EXPECT_EQ(r.get(), 3);  // ready: no violation
+    EXPECT_EQ(oneshot_blocking::violations(), before + 1);
+}
+
+TEST(OneShotBlockingTest, LogActionPrintsTheCall) {
+    NonblockingScope scope;
+    oneshot_blocking::set_action(oneshot_blocking::Action::Log);
+
+    auto [s, r] = OneShotChannel<void>::make();
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(r.get_for(1ms));
+    std::string err = testing::internal::GetCapturedStderr();
+    EXPECT_NE(err.find("blocking timed wait on a non-blocking thread"), std::string::npos);
+}
+
+#ifndef NDEBUG
+namespace {
+
+void timed_wait_on_marked_thread() {
+    oneshot_blocking::mark_nonblocking_thread();
+    oneshot_blocking::set_action(oneshot_blocking::Action::Abort);
+    auto pair = OneShot<int>::make();
+    pair.second.get_for(1ms);
+}
+
+} // namespace
+
+TEST(OneShotBlockingDeathTest, AbortActionAbortsInDebugBuilds) {
+    EXPECT_DEATH(timed_wait_on_marked_thread(), "non-blocking thread");
+}
+#endif
@@ -1,8 +1,11 @@
 #include <gtest/gtest.h>
 #include <thread>
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <optional>
+#include <cstdint>
+#include <vector>
 #include "OneShotChannel.hpp"
 
 using namespace std::chrono_literals;
@@ -152,6 +155,175 @@ TEST(OneShotChannelVoidTest, ExceptionPropagation) {
     t.join();
 }
 
+// --------------------------------------------------
+// Operational counters
+// --------------------------------------------------
+
+TEST(OneShotChannelStatsTest, CountsSetsRejectsAndResets) {
+    auto [s, r] = OneShotChannel<int>::make();
+
+    EXPECT_TRUE(s.set_value(1));
+    EXPECT_FALSE(s.set_value(2));
+    EXPECT_FALSE(s.set_exception(std::make_exception_ptr(std::runtime_error("late"))));
+    EXPECT_EQ(r.get(), 1);
+    EXPECT_TRUE(r.reset());
+
+    auto st = r.stats();
+    EXPECT_EQ(st.sets, 1u);
+    EXPECT_EQ(st.rejected_sets, 2u);
+    EXPECT_EQ(st.resets, 1u);
+    EXPECT_EQ(st.broken, 0u);
+    EXPECT_GE(st.lock_acquisitions, 5u);
+    EXPECT_EQ(s.stats().sets, st.sets);  // both ends see the same counters
+}
+
+TEST(OneShotChannelStatsTest, CountsFromBothEndsAddUp) {
+    // each end counts into its own block; stats() sums them
+    auto [s, r] = OneShotChannel<int>::make();
+    EXPECT_TRUE(s.reset());
+    EXPECT_TRUE(r.reset());
+    EXPECT_FALSE(r.get_for(1ms));
+    EXPECT_EQ(s.stats().resets, 2u);
+    EXPECT_EQ(s.stats().timeouts, 1u);
+    EXPECT_EQ(r.stats().lock_acquisitions, s.stats().lock_acquisitions);
+}
+
+TEST(OneShotChannelStatsTest, CountsTimeoutsAndLateValues) {
+    auto [s, r] = OneShotChannel<int>::make();
+
+    EXPECT_FALSE(r.get_for(5ms));
+    EXPECT_EQ(r.stats().timeouts, 1u);
+    EXPECT_EQ(r.stats().late_values, 0u);
+
+    // the value that get_for gave up on arrives afterwards
+    EXPECT_TRUE(s.set_value(7));
+    EXPECT_EQ(r.stats().late_values, 1u);
+
+    // a reset starts a new generation; the next on-time value is not late
+    s.reset();
+    EXPECT_TRUE(s.set_value(8));
+    EXPECT_EQ(r.get_for(10ms), std::optional<int>(8));
+    EXPECT_EQ(r.stats().late_values, 1u);
+}
+
+TEST(OneShotChannelStatsTest, CountsBrokenAndSwallowedExceptions) {
+    auto [s, r] = OneShotChannel<void>::make();
+
+    s = {};
+    EXPECT_FALSE(r.get_for(10ms));  // broken_promise is swallowed
+
+    auto st = r.stats();
+    EXPECT_EQ(st.broken, 1u);
+    EXPECT_EQ(st.swallowed_exceptions, 1u);
+    EXPECT_EQ(st.timeouts, 0u);
+}
+
+TEST(OneShotChannelStatsTest, GlobalAggregate) {
+    auto before = OneShotChannelStats::global();
+    {
+        auto [s, r] = OneShotChannel<int>::make();
+        s.set_value(1);  // not aggregated while disabled
+    }
+    EXPECT_EQ(OneShotChannelStats::global().sets, before.sets);
+
+    OneShotChannelStats::enable_global();
+    for (int i = 0; i < 3; ++i) {
+        auto [s, r] = OneShotChannel<int>::make();
+        s.set_value(i);
+        r.get();
+    }
+    OneShotChannelStats::enable_global(false);
+
+    EXPECT_EQ(OneShotChannelStats::global().sets, before.sets + 3);
+}
+
+// --------------------------------------------------
+// set_value_and_wait: backpressure
+// --------------------------------------------------
+
+TEST(OneShotChannelRendezvousTest, ProducerNeverRunsAheadOfTheConsumer) {
+    constexpr int kItems = 200;
+    auto [s, r] = OneShotChannel<int>::make();
+    std::atomic<int> consumed{0};
+    std::thread consumer([&, r = std::move(r)]() mutable {
+        for (int i = 0; i < kItems; ++i) {
+            EXPECT_EQ(r.get(), i);
+            ++consumed;
+            r.reset();
+        }
+    });
+    for (int i = 0; i < kItems; ++i) {
+        RendezvousResult res;
+        // returns once read, possibly before the consumer's reset(): retry like set_value
+        while ((res = s.set_value_and_wait(i)) == RendezvousResult::Rejected) std::this_thread::yield();
+        EXPECT_EQ(res, RendezvousResult::Consumed);
+        EXPECT_GE(consumed.load(), i);  // every earlier item was read before we got here
+    }
+    consumer.join();
+    EXPECT_EQ(consumed, kItems);
+}
+
+TEST(OneShotChannelRendezvousTest, TimedGetCountsAsTakenAndResetAsDiscarded) {
+    auto [s, r] = OneShotChannel<void>::make();
+    std::thread consumer([&r] {
+        std::this_thread::sleep_for(20ms);
+        EXPECT_TRUE(r.get_for(1s));
+    });
+    EXPECT_EQ(s.set_value_and_wait(), RendezvousResult::Consumed);
+    consumer.join();
+
+    r.reset();
+    std::thread resetter([&s] {
+        std::this_thread::sleep_for(20ms);
+        s.reset();  // discards the value unread
+    });
+    EXPECT_EQ(s.set_value_and_wait(), RendezvousResult::Discarded);
+    resetter.join();
+
+    // read, then reset before the sender got to run: still Consumed
+    std::thread reader([&r] {
+        std::this_thread::sleep_for(20ms);
+        r.get();
+        r.reset();
+    });
+    EXPECT_EQ(s.set_value_and_wait(), RendezvousResult::Consumed);
+    reader.join();
+}
+
+TEST(OneShotChannelRendezvousTest, DroppedReceiverAndTimeout) {
+    auto [s, r] = OneShotChannel<int>::make();
+    EXPECT_EQ(s.set_value_and_wait_for(1, 20ms), RendezvousResult::TimedOut);
+    EXPECT_EQ(s.set_value_and_wait(2), RendezvousResult::Rejected);  // 1 is still set
+    EXPECT_EQ(r.get(), 1);
+    r.reset();
+
+    std::thread dropper([r = std::move(r)]() mutable {
+        std::this_thread::sleep_for(20ms);
+        r = {};
+    });
+    EXPECT_EQ(s.set_value_and_wait(3), RendezvousResult::ReceiverGone);
+    dropper.join();
+    EXPECT_EQ(s.set_value_and_wait(4), RendezvousResult::Rejected);
+}
+
+TEST(OneShotChannelRendezvousTest, FinishedWaitKeepsTheNextWaitersFlag) {
+    constexpr int kRounds = 200;
+    for (int round = 0; round < kRounds; ++round) {
+        auto [s, r] = OneShotChannel<int>::make();
+        RendezvousResult first = RendezvousResult::Rejected, second = RendezvousResult::Rejected;
+        std::thread a([&s = s, &first] { first = s.set_value_and_wait(1); });
+        while (!r.ready()) std::this_thread::yield();
+        r.reset();  // discards 1; `a` may clean up only after `b` started waiting
+        std::thread b([&s = s, &second] { second = s.set_value_and_wait_for(2, 5s); });
+        a.join();
+        while (!r.ready()) std::this_thread::yield();
+        r = {};
+        b.join();
+        EXPECT_EQ(first, RendezvousResult::Discarded);
+        ASSERT_EQ(second, RendezvousResult::ReceiverGone) << "round " << round;
+    }
+}
+
 // --------------------------------------------------
 // Stress Tests: OneShotChannel<int>
 // To avoid calling reset, each iteration gets its own
@@ -219,3 +391,71 @@ TEST(OneShotChannelStressTest, HighConcurrencyVoid) {
     for (auto &th : threads) th.join();
     EXPECT_EQ(total.load(), kThreads * kIterations);
 }
+
+// --------------------------------------------------
+// Layout: Packed vs CacheAligned shared state
+// --------------------------------------------------
+
+namespace {
+
+// Records where the last channel state was allocated and how big it is.
+struct LayoutProbe {
+    struct Data {};
+    static inline std::uintptr_t address = 0;
+    static inline std::size_t size = 0;
+
+    static std::uint64_t now() noexcept { return 0; }
+    template<typename State>
+    static void on_create(State& s) noexcept {
+        address = reinterpret_cast<std::uintptr_t>(&s);
+        size = sizeof(State);
+    }
+    static void on_set(Data&) noexcept {}
+    static void on_broken(Data&) noexcept {}
+    static void on_wait(Data&) noexcept {}
+    static void on_wake(Data&, std::uint64_t) noexcept {}
+    static void on_timeout(Data&, std::uint64_t) noexcept {}
+    static void on_consume(Data&) noexcept {}
+    static void on_reset(Data&) noexcept {}
+};
+
+} // namespace
+
+TEST(OneShotChannelLayoutTest, CacheAlignedStateStartsAndEndsOnALine) {
+    std::vector<OneShotChannel<int, LayoutProbe, oneshot_layout::CacheAligned>::Receiver> keep;
+    for (int i = 0; i < 8; ++i) {
+        auto [s, r] = OneShotChannel<int, LayoutProbe, oneshot_layout::CacheAligned>::make();
+        EXPECT_EQ(LayoutProbe::address % oneshot_layout::cache_line, 0u);
+        EXPECT_EQ(LayoutProbe::size % oneshot_layout::cache_line, 0u);
+        keep.push_back(std::move(r));
+    }
+}
+
+TEST(OneShotChannelLayoutTest, PackedStateIsSmaller) {
+    OneShotChannel<int, LayoutProbe, oneshot_layout::CacheAligned>::make();
+    std::size_t aligned = LayoutProbe::size;
+    OneShotChannel<int, LayoutProbe>::make();
+    std::size_t packed = LayoutProbe::size;
+    EXPECT_LT(packed, aligned);
+    EXPECT_GE(aligned, 3 * oneshot_layout::cache_line);  // lock, sender and receiver lines
+}
+
+TEST(OneShotChannelLayoutTest, CacheAlignedBehavesLikePacked) {
+    using Channel = OneShotChannel<int, NullObserver, oneshot_layout::CacheAligned>;
+    auto [s, r] = Channel::make();
+
+    std::thread producer([&s = s]() { s.set_value(7); });
+    EXPECT_EQ(r.get(), 7);
+    producer.join();
+
+    EXPECT_TRUE(r.reset());
+    EXPECT_FALSE(r.get_for(5ms).has_value());
+    EXPECT_TRUE(s.set_value(8));
+    EXPECT_EQ(r.get_for(5ms), std::optional<int>(8));
+    EXPECT_EQ(s.stats().resets, 1u);
+    EXPECT_EQ(s.stats().late_values, 1u);
+
+    auto [vs, vr] = OneShotChannel<void, NullObserver, oneshot_layout::CacheAligned>::make();
+    vs.set_value();
+    EXPECT_TRUE(vr.get_for(5ms));
+}
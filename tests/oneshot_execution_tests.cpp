@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <string>
+#include "OneShotExecution.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Records how an execution receiver was completed
+struct Completion {
+    std::optional<int> value;
+    std::exception_ptr error;
+    bool stopped = false;
+    bool void_value = false;
+};
+
+struct RecordingReceiver {
+    using receiver_concept = oneshot_exec::receiver_t;
+    Completion* out;
+
+    void set_value(int v) && noexcept { out->value = v; }
+    void set_value() && noexcept { out->void_value = true; }
+    void set_error(std::exception_ptr e) && noexcept { out->error = e; }
+    void set_stopped() && noexcept { out->stopped = true; }
+    oneshot_exec::empty_env get_env() const noexcept { return {}; }
+};
+
+// Minimal just(v) sender feeding an execution receiver synchronously
+template<typename T>
+struct JustSender {
+    T value;
+
+    template<typename R>
+    struct Op {
+        T value;
+        R rcvr;
+        void start() noexcept { std::move(rcvr).set_value(std::move(value)); }
+    };
+
+    template<typename R>
+    Op<R> connect(R rcvr) && {
+        return Op<R>{std::move(value), std::move(rcvr)};
+    }
+};
+
+} // namespace
+
+// --------------------------------------------------
+// oneshot_exec adapter tests
+// --------------------------------------------------
+
+TEST(OneShotExecutionTest, ReceiverAsSenderCompletesWithValue) {
+    auto [s, r] = OneShot<int>::make();
+    Completion c;
+    auto op = oneshot_exec::as_sender(std::move(r)).connect(RecordingReceiver{&c});
+    op.start();
+    EXPECT_FALSE(c.value.has_value());  // start() never blocks
+
+    std::thread producer([s = std::move(s)]() mutable { s.set_value(17); });
+    producer.join();
+    EXPECT_EQ(c.value, std::optional<int>(17));
+}
+
+TEST(OneShotExecutionTest, AlreadyReadyCompletesInline) {
+    auto [s, r] = OneShot<int>::make();
+    s.set_value(3);
+    Completion c;
+    auto op = oneshot_exec::as_sender(std::move(r)).connect(RecordingReceiver{&c});
+    op.start();
+    EXPECT_EQ(c.value, std::optional<int>(3));
+}
+
+TEST(OneShotExecutionTest, ExceptionBecomesSetError) {
+    auto [s, r] = OneShot<int>::make();
+    Completion c;
+    auto op = oneshot_exec::as_sender(std::move(r)).connect(RecordingReceiver{&c});
+    op.start();
+    s.set_exception(std::make_exception_ptr(std::runtime_error("bad")));
+    ASSERT_TRUE(c.error);
+    EXPECT_THROW(std::rethrow_exception(c.error), std::runtime_error);
+    EXPECT_FALSE(c.stopped);
+}
+
+TEST(OneShotExecutionTest, BrokenPromiseBecomesSetStopped) {
+    auto [s, r] = OneShot<void>::make();
+    Completion c;
+    auto op = oneshot_exec::as_sender(std::move(r)).connect(RecordingReceiver{&c});
+    op.start();
+    s = {};
+    EXPECT_TRUE(c.stopped);
+    EXPECT_FALSE(c.void_value);
+}
+
+TEST(OneShotExecutionTest, VoidValue) {
+    auto [s, r] = OneShot<void>::make();
+    Completion c;
+    auto op = oneshot_exec::as_sender(std::move(r)).connect(RecordingReceiver{&c});
+    op.start();
+    s.set_value();
+    EXPECT_TRUE(c.void_value);
+}
+
+TEST(OneShotExecutionTest, OperationDestroyedBeforeCompletion) {
+    auto [s, r] = OneShot<int>::make();
+    Completion c;
+    {
+        auto op = oneshot_exec::as_sender(std::move(r)).connect(RecordingReceiver{&c});
+        op.start();
+    }
+    EXPECT_TRUE(s.set_value(1));  // nothing left to notify
+    EXPECT_FALSE(c.value.has_value());
+}
+
+TEST(OneShotExecutionTest, PipelineResultIntoSender) {
+    auto [s, r] = OneShot<std::string>::make();
+    auto op = JustSender<std::string>{"piped"}.connect(oneshot_exec::sink(std::move(s)));
+    op.start();
+    EXPECT_EQ(r.get(), "piped");
+}
+
+TEST(OneShotExecutionTest, SinkStoppedIsBrokenPromise) {
+    auto [s, r] = OneShot<int>::make();
+    auto sink = oneshot_exec::sink(std::move(s));
+    std::move(sink).set_stopped();
+    EXPECT_THROW(r.get(), std::future_error);
+}
+
+TEST(OneShotExecutionTest, ChainReceiverIntoSink) {
+    auto [s1, r1] = OneShot<int>::make();
+    auto [s2, r2] = OneShot<int>::make();
+    auto op = oneshot_exec::as_sender(std::move(r1)).connect(oneshot_exec::sink(std::move(s2)));
+    op.start();
+    s1.set_value(99);
+    EXPECT_EQ(r2.get(), 99);
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <vector>
+#include "OneShotFuture.hpp"
+#include "OneShotFiber.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotSelect.hpp"
+#include "BoundedChannel.hpp"
+#include "Exchanger.hpp"
+
+using namespace std::chrono_literals;
+
+// --------------------------------------------------
+// FiberScheduler + OneShot tests
+// --------------------------------------------------
+
+TEST(OneShotFiberTest, GetSuspendsOnlyTheFiber) {
+    FiberScheduler sched;
+    auto [s, r] = OneShot<int>::make();
+    std::vector<int> order;
+
+    sched.spawn([&, r = std::move(r)]() mutable {
+        order.push_back(1);
+        int v = r.get();  // parks; the carrier moves on to the next fiber
+        order.push_back(v);
+    });
+    sched.spawn([&, s = std::move(s)]() mutable {
+        order.push_back(2);
+        s.set_value(3);
+    });
+    sched.run();
+
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(OneShotFiberTest, CompletionFromAnotherThread) {
+    constexpr int kFibers = 200;
+    FiberScheduler sched;
+    std::vector<OneShot<int>::Sender> senders;
+    std::atomic<int> sum{0};
+
+    for (int i = 0; i < kFibers; ++i) {
+        auto [s, r] = OneShot<int>::make();
+        senders.push_back(std::move(s));
+        sched.spawn([&sum, r = std::move(r)]() mutable { sum += r.get(); });
+    }
+
+    std::thread producer([&]() {
+        std::this_thread::sleep_for(20ms);
+        for (int i = 0; i < kFibers; ++i) senders[i].set_value(i);
+    });
+    sched.run();  // all 200 fibers wait on one carrier thread
+    producer.join();
+
+    EXPECT_EQ(sum.load(), kFibers * (kFibers - 1) / 2);
+}
+
+TEST(OneShotFiberTest, TimedGetOnFiber) {
+    FiberScheduler sched;
+    auto [s, r] = OneShot<int>::make();
+    std::optional<int> early, late;
+    int ticks = 0;
+
+    sched.spawn([&, r = std::move(r)]() mutable {
+        early = r.get_for(20ms);
+        late = r.get_for(1s);
+    });
+    sched.spawn([&]() {
+        // keeps running while the other fiber is parked with a deadline
+        auto until = std::chrono::steady_clock::now() + 40ms;
+        while (std::chrono::steady_clock::now() < until) {
+            ++ticks;
+            FiberScheduler::yield();
+        }
+        s.set_value(8);
+    });
+    sched.run();
+
+    EXPECT_FALSE(early.has_value());
+    EXPECT_EQ(late, std::optional<int>(8));
+    EXPECT_GT(ticks, 1);
+}
+
+TEST(OneShotFiberTest, BrokenPromiseOnFiber) {
+    FiberScheduler sched;
+    auto [s, r] = OneShot<void>::make();
+    bool caught = false;
+
+    sched.spawn([&, r = std::move(r)]() mutable {
+        try {
+            r.get();
+        } catch (const std::future_error&) {
+            caught = true;
+        }
+    });
+    sched.spawn([&]() { s = {}; });
+    sched.run();
+
+    EXPECT_TRUE(caught);
+}
+
+TEST(OneShotFiberTest, ThreadsStillBlockOutsideFibers) {
+    EXPECT_FALSE(FiberScheduler::on_fiber());
+    auto [s, r] = OneShot<int>::make();
+    std::thread t([&]() {
+        std::this_thread::sleep_for(20ms);
+        s.set_value(1);
+    });
+    EXPECT_EQ(r.get(), 1);
+    t.join();
+}
+
+TEST(OneShotFiberTest, ExceptionEscapingFiberIsRethrownByRun) {
+    FiberScheduler sched;
+    bool other_ran = false;
+    sched.spawn([]() { throw std::runtime_error("fiber"); });
+    sched.spawn([&]() { other_ran = true; });
+    EXPECT_THROW(sched.run(), std::runtime_error);
+    EXPECT_TRUE(other_ran);
+}
+
+TEST(OneShotFiberTest, SelectParksOnlyTheFiber) {
+    using namespace oneshot_select;
+    FiberScheduler sched;
+    auto [rs, rr] = OneShot<int>::make();
+    auto [cs, cr] = OneShotChannel<void>::make();
+    std::vector<int> order;
+
+    sched.spawn([&]() {
+        order.push_back(1);
+        select(case_(rr, [&](int v) { order.push_back(v); }), case_(cr, [&] { order.push_back(-1); }));
+    });
+    sched.spawn([&]() {
+        order.push_back(2);
+        rs.set_value(3);
+    });
+    sched.spawn([&]() {
+        order.push_back(4);
+        std::size_t taken = select(case_(cr, [] {}), timeout(10ms, [] {}));
+        order.push_back(static_cast<int>(taken) + 10);
+    });
+    sched.run();
+
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 4, 3, 11}));
+}
+
+TEST(OneShotFiberTest, BoundedChannelParksFibersWhenFullOrEmpty) {
+    FiberScheduler sched;
+    auto [tx, rx] = Channel<int>::make(2);
+    std::vector<int> got;
+
+    sched.spawn([&, rx = std::move(rx)]() mutable {
+        try {
+            for (;;) got.push_back(rx.receive());
+        } catch (const std::future_error&) {
+        }
+    });
+    sched.spawn([&, tx = std::move(tx)]() mutable {
+        for (int i = 0; i < 20; ++i) tx.send(i);  // parks whenever the 2 slots are full
+    });
+    sched.run();  // one carrier thread: a blocked thread would deadlock here
+
+    std::vector<int> expected(20);
+    for (int i = 0; i < 20; ++i) expected[i] = i;
+    EXPECT_EQ(got, expected);
+}
+
+TEST(OneShotFiberTest, RendezvousParksTheSendingFiber) {
+    FiberScheduler sched;
+    auto [s, r] = OneShot<int>::make();
+    auto [cs, cr] = OneShotChannel<int>::make();
+    std::vector<int> order;
+
+    sched.spawn([&, s = std::move(s)]() mutable {
+        order.push_back(1);
+        EXPECT_EQ(s.set_value_and_wait(10), RendezvousResult::Consumed);  // parks
+        order.push_back(4);
+        EXPECT_EQ(cs.set_value_and_wait(20), RendezvousResult::Consumed);  // parks until the thread reads
+    });
+    sched.spawn([&, r = std::move(r)]() mutable {
+        order.push_back(2);
+        order.push_back(r.get() - 7);  // 3
+    });
+    // OneShotChannel receivers block the thread, so this one reads from outside the scheduler
+    std::thread reader([&cr] { EXPECT_EQ(cr.get(), 20); });
+    sched.run();  // one carrier thread: a blocked sender would deadlock here
+    reader.join();
+
+    EXPECT_EQ(order, (std::vector<int>{1, 2, 3, 4}));
+}
+
+TEST(OneShotFiberTest, ExchangerParksTheWaitingFiber) {
+    FiberScheduler sched;
+    Exchanger<int> ex;
+    std::vector<int> got(2);
+    for (int f = 0; f < 2; ++f) {
+        sched.spawn([&, f] {
+            for (int i = 0; i < 10; ++i) got[f] += ex.exchange(f + 1);  // the first to arrive parks
+        });
+    }
+    sched.run();  // one carrier thread: a blocked exchange would deadlock here
+
+    EXPECT_EQ(got, (std::vector<int>{20, 10}));
+}
+
+TEST(OneShotFiberTest, QuorumWaitParksTheFiber) {
+    FiberScheduler sched;
+    std::vector<OneShot<int>::Sender> senders;
+    std::vector<OneShot<int>::Receiver> receivers;
+    for (int i = 0; i < 3; ++i) {
+        auto [s, r] = OneShot<int>::make();
+        senders.push_back(std::move(s));
+        receivers.push_back(std::move(r));
+    }
+    std::vector<std::size_t> indices;
+
+    sched.spawn([&] { indices = oneshot_select::when_n(2, receivers).indices; });  // parks
+    sched.spawn([&] {
+        senders[2].set_value(2);
+        FiberScheduler::yield();
+        senders[0].set_value(0);  // reaches the quorum
+    });
+    sched.run();  // one carrier thread: a blocked wait would deadlock here
+
+    EXPECT_EQ(indices, (std::vector<std::size_t>{2, 0}));
+    EXPECT_TRUE(senders[1].cancelled());
+}
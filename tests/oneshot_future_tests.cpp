@@ -3,6 +3,9 @@
 #include <chrono>
 #include <future>
 #include <optional>
+#include <stdexcept>
+#include <vector>
+#include <atomic>
 #include "OneShotFuture.hpp"
 
 using namespace std::chrono_literals;
@@ -79,6 +82,167 @@ TEST(OneShotTest, ReadyCheck) {
     EXPECT_EQ(r.get(), 5);
 }
 
+namespace {
+
+// Moves throw when `fail` is set, to exercise a payload that cannot be stored.
+struct MoveMayThrow {
+    int v;
+    bool fail;
+    MoveMayThrow(int v, bool fail = false) : v(v), fail(fail) {}
+    MoveMayThrow(MoveMayThrow&& o) : v(o.v), fail(o.fail) {
+        if (fail) throw std::runtime_error("move failed");
+    }
+};
+
+} // namespace
+
+TEST(OneShotTest, ThrowingMoveBecomesTheResult) {
+    auto [s1, r1] = OneShot<MoveMayThrow>::make();
+    EXPECT_TRUE(s1.set_value(MoveMayThrow{1, true}));
+    EXPECT_FALSE(s1.set_value(MoveMayThrow{2}));
+    ASSERT_TRUE(r1.wait_for(200ms));  // was left claimed but never ready
+    EXPECT_THROW(r1.get(), std::runtime_error);
+
+    auto [s2, r2] = OneShot<MoveMayThrow>::make();
+    EXPECT_FALSE(s2.try_set_value(MoveMayThrow{1, true}).has_value());
+    EXPECT_THROW(r2.get(), std::runtime_error);
+
+    auto [s3, r3] = OneShot<MoveMayThrow>::make();
+    EXPECT_EQ(s3.set_value_and_wait_for(MoveMayThrow{1, true}, 1ms), RendezvousResult::TimedOut);
+    EXPECT_THROW(r3.get(), std::runtime_error);
+
+    std::vector<OneShot<MoveMayThrow>::Sender> senders;
+    std::vector<OneShot<MoveMayThrow>::Receiver> receivers;
+    for (int i = 0; i < 3; ++i) {
+        auto [s, r] = OneShot<MoveMayThrow>::make();
+        senders.push_back(std::move(s));
+        receivers.push_back(std::move(r));
+    }
+    MoveMayThrow values[3] = {{0}, {1, true}, {2}};
+    EXPECT_EQ(OneShot<MoveMayThrow>::complete_batch(senders.data(), values, 3), 3u);
+    EXPECT_EQ(receivers[0].get().v, 0);
+    EXPECT_THROW(receivers[1].get(), std::runtime_error);
+    EXPECT_EQ(receivers[2].get().v, 2);
+}
+
+// --------------------------------------------------
+// try_set_value: undelivered values come back
+// --------------------------------------------------
+
+TEST(OneShotTrySetValueTest, DeliversToALiveReceiver) {
+    auto [s, r] = OneShot<std::vector<int>>::make();
+    auto back = s.try_set_value(std::vector<int>{1, 2, 3});
+    EXPECT_FALSE(back.has_value());
+    EXPECT_EQ(r.get(), (std::vector<int>{1, 2, 3}));
+}
+
+TEST(OneShotTrySetValueTest, HandsBackTheBufferWhenReceiverWasDropped) {
+    auto [s, r] = OneShot<std::vector<int>>::make();
+    r = {};
+
+    std::vector<int> buffer(1 << 16, 7);
+    const int* storage = buffer.data();
+    auto back = s.try_set_value(std::move(buffer));
+    ASSERT_TRUE(back.has_value());
+    EXPECT_EQ(back->data(), storage);  // same allocation, ready for reuse
+    EXPECT_EQ(back->size(), 1u << 16);
+    EXPECT_FALSE(s.set_value(std::vector<int>{}));  // the sender is complete
+}
+
+TEST(OneShotTrySetValueTest, HandsBackWhenAlreadyCompletedOrEmpty) {
+    auto [s, r] = OneShot<int>::make();
+    EXPECT_TRUE(s.set_value(1));
+    EXPECT_EQ(s.try_set_value(2), std::optional<int>(2));
+    EXPECT_EQ(r.get(), 1);
+
+    OneShot<int>::Sender empty;
+    EXPECT_EQ(empty.try_set_value(3), std::optional<int>(3));
+}
+
+TEST(OneShotTrySetValueTest, ConsumedOrMovedReceiverIsNotDropped) {
+    auto [s, r] = OneShot<int>::make();
+    OneShot<int>::Receiver moved = std::move(r);  // r is empty, dropping it changes nothing
+    r = {};
+    EXPECT_FALSE(s.try_set_value(4).has_value());
+    EXPECT_EQ(moved.get(), 4);
+}
+
+TEST(OneShotTrySetValueTest, ForwardedReceiverStillDelivers) {
+    auto [down_s, down_r] = OneShot<int>::make();
+    auto [up_s, up_r] = OneShot<int>::make();
+    OneShot<int>::forward(std::move(down_r), std::move(up_s));
+
+    EXPECT_FALSE(down_s.try_set_value(9).has_value());
+    EXPECT_EQ(up_r.get(), 9);
+}
+
+// --------------------------------------------------
+// set_value_and_wait: rendezvous with the receiver
+// --------------------------------------------------
+
+TEST(OneShotRendezvousTest, ReturnsOnceTheReceiverTookTheValue) {
+    auto [s, r] = OneShot<int>::make();
+    std::atomic<bool> taken{false};
+    std::thread consumer([&, r = std::move(r)]() mutable {
+        std::this_thread::sleep_for(50ms);
+        taken = true;
+        EXPECT_EQ(r.get(), 7);
+    });
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(s.set_value_and_wait(7), RendezvousResult::Consumed);
+    EXPECT_TRUE(taken);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 40ms);
+    consumer.join();
+}
+
+TEST(OneShotRendezvousTest, ReportsADroppedReceiver) {
+    auto [s1, r1] = OneShot<int>::make();
+    r1 = {};
+    EXPECT_EQ(s1.set_value_and_wait(1), RendezvousResult::ReceiverGone);
+
+    auto [s2, r2] = OneShot<void>::make();
+    std::thread dropper([r = std::move(r2)]() mutable {
+        std::this_thread::sleep_for(20ms);
+        r = {};  // dropped while the sender waits
+    });
+    EXPECT_EQ(s2.set_value_and_wait(), RendezvousResult::ReceiverGone);
+    dropper.join();
+}
+
+TEST(OneShotRendezvousTest, TimeoutLeavesTheValueSet) {
+    auto [s, r] = OneShot<int>::make();
+    EXPECT_EQ(s.set_value_and_wait_for(3, 20ms), RendezvousResult::TimedOut);
+    EXPECT_TRUE(r.ready());
+    EXPECT_EQ(r.get(), 3);
+
+    auto [vs, vr] = OneShot<void>::make();
+    std::thread consumer([r = std::move(vr)]() mutable { r.get(); });
+    EXPECT_EQ(vs.set_value_and_wait_for(5s), RendezvousResult::Consumed);
+    consumer.join();
+}
+
+TEST(OneShotRendezvousTest, RejectedWhenNothingIsSet) {
+    auto [s, r] = OneShot<int>::make();
+    s.set_value(1);
+    EXPECT_EQ(s.set_value_and_wait(2), RendezvousResult::Rejected);
+    EXPECT_EQ(r.get(), 1);
+
+    OneShot<int>::Sender empty;
+    EXPECT_EQ(empty.set_value_and_wait(3), RendezvousResult::Rejected);
+}
+
+TEST(OneShotRendezvousTest, ForwardedValueCountsAsTakenOnDelivery) {
+    auto [down_s, down_r] = OneShot<int>::make();
+    auto [up_s, up_r] = OneShot<int>::make();
+    OneShot<int>::forward(std::move(down_r), std::move(up_s));
+    EXPECT_EQ(down_s.set_value_and_wait(4), RendezvousResult::Consumed);
+    EXPECT_EQ(up_r.get(), 4);
+
+    auto [s2, r2] = OneShot<int>::make();
+    OneShot<int>::forward(std::move(r2), OneShot<int>::Sender{});  // nowhere to go
+    EXPECT_EQ(s2.set_value_and_wait(5), RendezvousResult::ReceiverGone);
+}
+
 // --------------------------------------------------
 // OneShot<void> tests
 // --------------------------------------------------
@@ -117,3 +281,205 @@ TEST(OneShotVoidTest, BrokenPromiseThrows) {
     EXPECT_THROW(r.get(), std::future_error);
 }
 
+
+// --------------------------------------------------
+// Batch completion tests
+// --------------------------------------------------
+
+TEST(OneShotBatchTest, CompletesEverySender) {
+    constexpr int kCount = 512;
+    std::vector<OneShot<int>::Sender> senders;
+    std::vector<OneShot<int>::Receiver> receivers;
+    std::vector<int> values;
+    for (int i = 0; i < kCount; ++i) {
+        auto [s, r] = OneShot<int>::make();
+        senders.push_back(std::move(s));
+        receivers.push_back(std::move(r));
+        values.push_back(i * 3);
+    }
+
+    EXPECT_EQ(OneShot<int>::complete_batch(senders, values), static_cast<std::size_t>(kCount));
+    for (int i = 0; i < kCount; ++i) {
+        EXPECT_TRUE(receivers[i].ready());
+        EXPECT_EQ(receivers[i].get(), i * 3);
+    }
+    EXPECT_FALSE(senders[0].set_value(1));  // already used
+}
+
+TEST(OneShotBatchTest, SkipsUsedAndEmptySenders) {
+    std::vector<OneShot<int>::Sender> senders(3);
+    std::vector<OneShot<int>::Receiver> receivers(3);
+    for (int i = 0; i < 2; ++i) {
+        auto [s, r] = OneShot<int>::make();
+        senders[i] = std::move(s);
+        receivers[i] = std::move(r);
+    }
+    senders[1].set_value(-1);
+    std::vector<int> values{10, 11, 12};
+
+    EXPECT_EQ(OneShot<int>::complete_batch(senders, values), 1u);
+    EXPECT_EQ(receivers[0].get(), 10);
+    EXPECT_EQ(receivers[1].get(), -1);
+}
+
+TEST(OneShotBatchTest, WakesBlockedReceivers) {
+    constexpr int kCount = 8;
+    std::vector<OneShot<int>::Sender> senders;
+    std::vector<std::thread> consumers;
+    std::atomic<int> sum{0};
+    for (int i = 0; i < kCount; ++i) {
+        auto [s, r] = OneShot<int>::make();
+        senders.push_back(std::move(s));
+        consumers.emplace_back([&sum, r = std::move(r)]() mutable { sum += r.get(); });
+    }
+    std::this_thread::sleep_for(30ms);  // let some consumers block
+
+    std::vector<int> values{1, 2, 3, 4, 5, 6, 7, 8};
+    OneShot<int>::complete_batch(senders, values);
+    for (auto& t : consumers) t.join();
+    EXPECT_EQ(sum.load(), 36);
+}
+
+TEST(OneShotBatchTest, VoidBatch) {
+    std::vector<OneShot<void>::Sender> senders;
+    std::vector<OneShot<void>::Receiver> receivers;
+    for (int i = 0; i < 1500; ++i) {  // spans more than one internal chunk
+        auto [s, r] = OneShot<void>::make();
+        senders.push_back(std::move(s));
+        receivers.push_back(std::move(r));
+    }
+    EXPECT_EQ(OneShot<void>::complete_batch(senders), 1500u);
+    for (auto& r : receivers) EXPECT_TRUE(r.get_for(0ms));
+}
+
+// --------------------------------------------------
+// Forwarding tests
+// --------------------------------------------------
+
+TEST(OneShotForwardTest, ForwardsValueWithoutThread) {
+    auto [down_s, down_r] = OneShot<int>::make();
+    auto [up_s, up_r] = OneShot<int>::make();
+
+    OneShot<int>::forward(std::move(down_r), std::move(up_s));
+    EXPECT_FALSE(up_r.ready());
+
+    std::thread producer([s = std::move(down_s)]() mutable {
+        std::this_thread::sleep_for(20ms);
+        s.set_value(5);
+    });
+    EXPECT_EQ(up_r.get(), 5);
+    producer.join();
+}
+
+TEST(OneShotForwardTest, AlreadyCompletedForwardsImmediately) {
+    auto [down_s, down_r] = OneShot<int>::make();
+    auto [up_s, up_r] = OneShot<int>::make();
+    down_s.set_value(8);
+
+    up_s.set_from(std::move(down_r));
+    EXPECT_TRUE(up_r.ready());
+    EXPECT_EQ(up_r.get(), 8);
+}
+
+TEST(OneShotForwardTest, ExceptionsAndBrokenPromiseForwarded) {
+    auto [s1, r1] = OneShot<int>::make();
+    auto [s2, r2] = OneShot<int>::make();
+    OneShot<int>::forward(std::move(r1), std::move(s2));
+    s1.set_exception(std::make_exception_ptr(std::runtime_error("down")));
+    EXPECT_THROW(r2.get(), std::runtime_error);
+
+    auto [s3, r3] = OneShot<void>::make();
+    auto [s4, r4] = OneShot<void>::make();
+    s4.set_from(std::move(r3));
+    s3 = {};
+    EXPECT_THROW(r4.get(), std::future_error);
+}
+
+TEST(OneShotForwardTest, ProxyChainsInEitherOrder) {
+    // downstream-first: a -> b, then b -> c
+    {
+        auto [sa, ra] = OneShot<int>::make();
+        auto [sb, rb] = OneShot<int>::make();
+        auto [sc, rc] = OneShot<int>::make();
+        OneShot<int>::forward(std::move(ra), std::move(sb));
+        OneShot<int>::forward(std::move(rb), std::move(sc));
+        sa.set_value(1);
+        EXPECT_EQ(rc.get(), 1);
+    }
+    // upstream-first: b -> c, then a -> b
+    {
+        auto [sa, ra] = OneShot<int>::make();
+        auto [sb, rb] = OneShot<int>::make();
+        auto [sc, rc] = OneShot<int>::make();
+        OneShot<int>::forward(std::move(rb), std::move(sc));
+        OneShot<int>::forward(std::move(ra), std::move(sb));
+        sa.set_value(2);
+        EXPECT_EQ(rc.get(), 2);
+    }
+}
+
+TEST(OneShotForwardTest, LongChainCollapses) {
+    constexpr int kHops = 10000;
+    auto [head_s, head_r] = OneShot<int>::make();
+    OneShot<int>::Receiver tail = std::move(head_r);
+    for (int i = 0; i < kHops; ++i) {
+        auto [s, r] = OneShot<int>::make();
+        OneShot<int>::forward(std::move(tail), std::move(s));
+        tail = std::move(r);
+    }
+    head_s.set_value(77);  // no per-hop recursion
+    EXPECT_EQ(tail.get(), 77);
+}
+
+namespace {
+
+// Counts live shared states
+struct LiveStates {
+    struct Data {
+        Data() { ++live; }
+        ~Data() { --live; }
+    };
+    static inline int live = 0;
+
+    static std::uint64_t now() noexcept { return 0; }
+    static void on_create(Data&) noexcept {}
+    static void on_set(Data&) noexcept {}
+    static void on_broken(Data&) noexcept {}
+    static void on_wait(Data&) noexcept {}
+    static void on_wake(Data&, std::uint64_t) noexcept {}
+    static void on_timeout(Data&, std::uint64_t) noexcept {}
+    static void on_consume(Data&) noexcept {}
+    static void on_reset(Data&) noexcept {}
+};
+
+} // namespace
+
+TEST(OneShotForwardTest, ForwardingIntoItselfFreesTheState) {
+    using Shot = OneShot<int, LiveStates>;
+    {
+        auto [s, r] = Shot::make();
+        s.set_from(std::move(r));
+        EXPECT_FALSE(s);
+    }
+    EXPECT_EQ(LiveStates::live, 0);
+
+    // around a chain: a -> b, then b -> a
+    {
+        auto [sa, ra] = Shot::make();
+        auto [sb, rb] = Shot::make();
+        Shot::forward(std::move(ra), std::move(sb));
+        Shot::forward(std::move(rb), std::move(sa));
+    }
+    EXPECT_EQ(LiveStates::live, 0);
+}
+
+TEST(OneShotForwardTest, ConcurrentForwardAndComplete) {
+    for (int i = 0; i < 200; ++i) {
+        auto [s1, r1] = OneShot<int>::make();
+        auto [s2, r2] = OneShot<int>::make();
+        std::thread producer([s = std::move(s1), i]() mutable { s.set_value(i); });
+        OneShot<int>::forward(std::move(r1), std::move(s2));
+        EXPECT_EQ(r2.get(), i);
+        producer.join();
+    }
+}
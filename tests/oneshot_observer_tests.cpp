@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <type_traits>
+#include "OneShotFuture.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotObserver.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Counts every hook invocation
+struct CountingObserver {
+    struct Data {};
+    struct Counts {
+        int create = 0, set = 0, broken = 0, wait = 0, wake = 0, timeout = 0, consume = 0, reset = 0;
+    };
+    static Counts& counts() {
+        static Counts c;
+        return c;
+    }
+
+    static std::uint64_t now() noexcept { return 0; }
+    static void on_create(Data&) noexcept { counts().create++; }
+    static void on_set(Data&) noexcept { counts().set++; }
+    static void on_broken(Data&) noexcept { counts().broken++; }
+    static void on_wait(Data&) noexcept { counts().wait++; }
+    static void on_wake(Data&, std::uint64_t) noexcept { counts().wake++; }
+    static void on_timeout(Data&, std::uint64_t) noexcept { counts().timeout++; }
+    static void on_consume(Data&) noexcept { counts().consume++; }
+    static void on_reset(Data&) noexcept { counts().reset++; }
+};
+
+struct LatencyTag {};
+using Latency = LatencyObserver<LatencyTag>;
+
+} // namespace
+
+static_assert(std::is_empty<NullObserver::Data>::value, "default observer must add no state");
+
+// --------------------------------------------------
+// Observer hook tests
+// --------------------------------------------------
+
+TEST(OneShotObserverTest, OneShotHooks) {
+    CountingObserver::counts() = {};
+    {
+        auto [s, r] = OneShot<int, CountingObserver>::make();
+        EXPECT_FALSE(r.get_for(1ms).has_value());
+        s.set_value(1);
+        EXPECT_EQ(r.get(), 1);
+    }
+    {
+        auto [s, r] = OneShot<void, CountingObserver>::make();
+        s = {};
+        EXPECT_THROW(r.get(), std::future_error);
+    }
+    auto& c = CountingObserver::counts();
+    EXPECT_EQ(c.create, 2);
+    EXPECT_EQ(c.set, 1);
+    EXPECT_EQ(c.broken, 1);
+    EXPECT_EQ(c.timeout, 1);
+    EXPECT_EQ(c.wake, 2);
+    EXPECT_EQ(c.wait, c.wake + c.timeout);
+    EXPECT_EQ(c.consume, 2);
+}
+
+TEST(OneShotObserverTest, ChannelHooks) {
+    CountingObserver::counts() = {};
+    auto [s, r] = OneShotChannel<int, CountingObserver>::make();
+    EXPECT_FALSE(r.get_for(1ms).has_value());
+    s.set_value(4);
+    EXPECT_EQ(r.get(), 4);
+    s.reset();
+    s.set_value(5);
+    EXPECT_EQ(r.get_for(10ms), std::optional<int>(5));
+
+    auto& c = CountingObserver::counts();
+    EXPECT_EQ(c.create, 1);
+    EXPECT_EQ(c.set, 2);
+    EXPECT_EQ(c.reset, 1);
+    EXPECT_EQ(c.timeout, 1);
+    EXPECT_EQ(c.wake, 2);
+    EXPECT_EQ(c.wait, c.wake + c.timeout);
+    EXPECT_EQ(c.consume, 2);
+}
+
+TEST(OneShotObserverTest, LatencyHistogramsRecord) {
+    Latency::clear();
+    constexpr int kRounds = 20;
+    for (int i = 0; i < kRounds; ++i) {
+        auto [s, r] = OneShot<int, Latency>::make();
+        std::thread t([s = std::move(s)]() mutable {
+            std::this_thread::sleep_for(1ms);
+            s.set_value(1);
+        });
+        r.get();
+        t.join();
+    }
+    auto [s, r] = OneShotChannel<void, Latency>::make();
+    EXPECT_FALSE(r.get_for(1ms));
+
+    auto snap = Latency::snapshot();
+    EXPECT_EQ(snap.set_to_wake.count, static_cast<std::uint64_t>(kRounds));
+    EXPECT_EQ(snap.wait.count, static_cast<std::uint64_t>(kRounds + 1));
+    EXPECT_EQ(snap.timeouts, 1u);
+    // receivers waited ~1ms for the value
+    double p50_ns = static_cast<double>(snap.wait.percentile(0.5)) / snap.ticks_per_ns;
+    EXPECT_GT(p50_ns, 500000.0);
+}
+
+TEST(OneShotObserverTest, LatencyChannelResetsWhileReceiversWake) {
+    // on_reset rewrites the per-state timestamp that waking receivers read
+    Latency::clear();
+    auto [s, r] = OneShotChannel<int, Latency>::make();
+    std::atomic<bool> stop{false};
+    std::thread producer([&s = s, &stop] {
+        while (!stop.load()) {
+            s.set_value(1);
+            s.reset();
+        }
+    });
+    for (int i = 0; i < 200; ++i) r.get_for(100us);
+    stop = true;
+    producer.join();
+    auto snap = Latency::snapshot();
+    EXPECT_EQ(snap.wait.count, 200u);
+    EXPECT_LE(snap.set_to_wake.count, 200u);
+}
+
+TEST(OneShotObserverTest, HistogramBuckets) {
+    oneshot_obs::Histogram h;
+    for (std::uint64_t v = 0; v < 1000; ++v) h.record(v);
+    h.record(std::uint64_t(1) << 40);
+    auto snap = h.snapshot();
+    EXPECT_EQ(snap.count, 1001u);
+    EXPECT_EQ(snap.percentile(0.0), 0u);
+    auto p50 = snap.percentile(0.5);
+    EXPECT_GE(p50, 500u);
+    EXPECT_LE(p50, 532u);  // within one sub-bucket
+    EXPECT_GE(snap.percentile(1.0), std::uint64_t(1) << 40);
+
+    for (std::uint64_t v : {0ull, 15ull, 16ull, 17ull, 1000ull, ~0ull}) {
+        EXPECT_GE(oneshot_obs::Histogram::upper_bound(oneshot_obs::Histogram::index(v)), v);
+    }
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <thread>
+#include <vector>
+#include "OneShotFuture.hpp"
+#include "BoundedChannel.hpp"
+#include "OneShotPool.hpp"
+
+using oneshot_pool::Pool;
+using oneshot_pool::Pooled;
+
+// --------------------------------------------------
+// Acquire, return, reuse
+// --------------------------------------------------
+
+TEST(OneShotPoolTest, ReturnedBufferIsReusedAsItWasLeft) {
+    Pool<std::vector<int>> pool;
+    const int* storage;
+    {
+        auto buf = pool.acquire();
+        buf->assign(1000, 1);
+        storage = buf->data();
+    }
+    auto again = pool.acquire();
+    EXPECT_EQ(again->data(), storage);
+    EXPECT_EQ(again->size(), 1000u);
+
+    auto s = pool.stats();
+    EXPECT_EQ(s.created, 1u);
+    EXPECT_EQ(s.acquired, 2u);
+    EXPECT_EQ(s.reused, 1u);
+    EXPECT_EQ(s.returned, 1u);
+    EXPECT_EQ(s.outstanding, 1u);
+    EXPECT_EQ(s.idle, 0u);
+}
+
+TEST(OneShotPoolTest, NewBuffersAreBuiltFromAcquireArguments) {
+    Pool<std::vector<int>> pool;
+    auto a = pool.acquire(3, 7);
+    auto b = pool.acquire(2, 9);
+    EXPECT_EQ(*a, (std::vector<int>{7, 7, 7}));
+    EXPECT_EQ(*b, (std::vector<int>{9, 9}));
+    EXPECT_NE(a.get(), b.get());
+}
+
+TEST(OneShotPoolTest, ReserveFillsThePoolUpFront) {
+    Pool<std::vector<int>> pool;
+    pool.reserve(4, 16);
+    EXPECT_EQ(pool.stats().idle, 4u);
+
+    auto buf = pool.acquire();
+    EXPECT_EQ(buf->size(), 16u);
+    EXPECT_EQ(pool.stats().created, 4u);
+    EXPECT_EQ(pool.stats().reused, 1u);
+    EXPECT_EQ(pool.stats().idle, 3u);
+}
+
+TEST(OneShotPoolTest, MovedAndResetHandles) {
+    Pool<int> pool;
+    auto a = pool.acquire(1);
+    Pooled<int> b = std::move(a);
+    EXPECT_FALSE(a);
+    EXPECT_EQ(*b, 1);
+    b.reset();
+    EXPECT_FALSE(b);
+    EXPECT_EQ(pool.stats().returned, 1u);
+
+    Pooled<int> c = pool.acquire();
+    c = pool.acquire(2);  // returns the first buffer
+    EXPECT_EQ(pool.stats().returned, 2u);
+    EXPECT_EQ(pool.stats().outstanding, 1u);
+}
+
+TEST(OneShotPoolTest, HandlesMayOutliveThePool) {
+    Pooled<std::vector<int>> kept;
+    {
+        Pool<std::vector<int>> pool;
+        kept = pool.acquire(8, 1);
+    }
+    EXPECT_EQ(kept->size(), 8u);
+    kept.reset();  // frees it with the pool's storage
+}
+
+// --------------------------------------------------
+// Round trips through OneShot and Channel
+// --------------------------------------------------
+
+TEST(OneShotPoolTest, ConsumerReturnsThroughOneShot) {
+    Pool<std::vector<char>> pool;
+    for (int i = 0; i < 50; ++i) {
+        auto [s, r] = OneShot<Pooled<std::vector<char>>>::make();
+        auto buf = pool.acquire(1 << 16);
+        std::thread consumer([r = std::move(r)]() mutable {
+            auto got = r.get();
+            EXPECT_EQ(got->size(), 1u << 16);
+        });  // `got` goes back to the pool here, on the consumer's thread
+        s.set_value(std::move(buf));
+        consumer.join();
+    }
+    auto st = pool.stats();
+    EXPECT_EQ(st.created, 1u);
+    EXPECT_EQ(st.reused, 49u);
+    EXPECT_EQ(st.outstanding, 0u);
+}
+
+TEST(OneShotPoolTest, ManyConsumersReturnConcurrently) {
+    constexpr int kConsumers = 4;
+    constexpr int kItems = 20000;
+    Pool<std::vector<int>> pool;
+    auto [tx, rx] = Channel<Pooled<std::vector<int>>>::make(16);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < kConsumers; ++c) {
+        consumers.emplace_back([rx = rx]() mutable {
+            try {
+                for (;;) EXPECT_EQ(rx.receive()->size(), 64u);  // returned right away
+            } catch (const std::future_error&) {}  // closed and drained
+        });
+    }
+    for (int i = 0; i < kItems; ++i) tx.send(pool.acquire(64));
+    tx.close();
+    for (auto& t : consumers) t.join();
+
+    auto st = pool.stats();
+    EXPECT_EQ(st.acquired, std::uint64_t(kItems));
+    EXPECT_EQ(st.returned, std::uint64_t(kItems));
+    EXPECT_EQ(st.outstanding, 0u);
+    EXPECT_EQ(st.idle, st.created);
+    EXPECT_LT(st.created, st.acquired);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include "OneShotFuture.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotRegistry.hpp"
+
+using namespace std::chrono_literals;
+
+// --------------------------------------------------
+// Pending-state registry tests
+// --------------------------------------------------
+
+TEST(OneShotRegistryTest, TracksOutstandingStates) {
+    auto before = oneshot_registry::snapshot(0);
+    {
+        auto [s1, r1] = OneShot<int, RegistryObserver>::make();
+        auto [s2, r2] = OneShot<void, RegistryObserver>::make();
+
+        auto snap = oneshot_registry::snapshot(0);
+        EXPECT_EQ(snap.outstanding, before.outstanding + 2);
+        EXPECT_GT(snap.bytes, before.bytes);
+
+        s1.set_value(1);  // completed: no longer pending
+        EXPECT_EQ(oneshot_registry::snapshot(0).outstanding, before.outstanding + 1);
+    }  // s2 broken, both states destroyed
+    auto after = oneshot_registry::snapshot(0);
+    EXPECT_EQ(after.outstanding, before.outstanding);
+    EXPECT_EQ(after.bytes, before.bytes);
+}
+
+TEST(OneShotRegistryTest, ReportsOldestWithLabelAndThread) {
+    std::optional<OneShot<int, RegistryObserver>::Sender> old_sender;
+    std::thread::id maker;
+    std::thread t([&] {
+        oneshot_obs::ScopedLabel label("old");
+        auto [s, r] = OneShot<int, RegistryObserver>::make();
+        old_sender.emplace(std::move(s));
+        maker = std::this_thread::get_id();
+    });  // the maker thread exits; its state stays registered
+    t.join();
+    std::this_thread::sleep_for(2ms);
+
+    oneshot_obs::ScopedLabel label("new");
+    auto [s, r] = OneShot<int, RegistryObserver>::make();
+
+    auto snap = oneshot_registry::snapshot(2);
+    ASSERT_EQ(snap.oldest.size(), 2u);
+    EXPECT_STREQ(snap.oldest[0].label, "old");
+    EXPECT_EQ(snap.oldest[0].thread, maker);
+    EXPECT_GE(snap.oldest[0].age, 2ms);
+    EXPECT_STREQ(snap.oldest[1].label, "new");
+    EXPECT_EQ(snap.oldest[1].thread, std::this_thread::get_id());
+
+    old_sender.reset();
+}
+
+TEST(OneShotRegistryTest, ReportsBlockedReceivers) {
+    auto [s, r] = OneShot<int, RegistryObserver>::make();
+    std::thread consumer([r = std::move(r)]() mutable { EXPECT_EQ(r.get(), 5); });
+
+    std::this_thread::sleep_for(30ms);
+    auto snap = oneshot_registry::snapshot(0, 10ms);
+    ASSERT_EQ(snap.blocked.size(), 1u);
+    EXPECT_GE(snap.blocked[0].blocked, 10ms);
+    EXPECT_TRUE(oneshot_registry::snapshot(0, 10s).blocked.empty());
+
+    s.set_value(5);
+    consumer.join();
+    EXPECT_TRUE(oneshot_registry::snapshot(0, 0ns).blocked.empty());
+}
+
+TEST(OneShotRegistryTest, ChannelResetReregisters) {
+    auto before = oneshot_registry::snapshot(0).outstanding;
+    auto [s, r] = OneShotChannel<int, RegistryObserver>::make();
+    EXPECT_EQ(oneshot_registry::snapshot(0).outstanding, before + 1);
+
+    s.set_value(1);
+    EXPECT_EQ(r.get(), 1);
+    EXPECT_EQ(oneshot_registry::snapshot(0).outstanding, before);
+
+    r.reset();
+    EXPECT_EQ(oneshot_registry::snapshot(0).outstanding, before + 1);
+    r.reset();  // re-arming a pending channel does not double count
+    EXPECT_EQ(oneshot_registry::snapshot(0).outstanding, before + 1);
+
+    s = {};  // broken
+    EXPECT_EQ(oneshot_registry::snapshot(0).outstanding, before);
+}
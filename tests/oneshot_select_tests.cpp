@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "OneShotFuture.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotSelect.hpp"
+
+using namespace std::chrono_literals;
+using oneshot_select::case_;
+using oneshot_select::default_;
+using oneshot_select::select;
+using oneshot_select::timeout;
+
+// --------------------------------------------------
+// Ready cases, default_ and timeout
+// --------------------------------------------------
+
+TEST(OneShotSelectTest, ReadyCaseRunsWithoutWaiting) {
+    auto [rs, rr] = OneShot<int>::make();
+    auto [cs, cr] = OneShotChannel<void>::make();
+    rs.set_value(42);
+
+    int got = 0;
+    bool cancelled = false;
+    std::size_t taken = select(case_(rr, [&](int v) { got = v; }), case_(cr, [&] { cancelled = true; }),
+                               timeout(5s, [] { FAIL() << "timed out"; }));
+
+    EXPECT_EQ(taken, 0u);
+    EXPECT_EQ(got, 42);
+    EXPECT_FALSE(cancelled);
+    EXPECT_FALSE(rr);  // a OneShot case consumes its receiver
+}
+
+TEST(OneShotSelectTest, FirstReadyCaseInArgumentOrderWins) {
+    auto [as, ar] = OneShot<int>::make();
+    auto [bs, br] = OneShotChannel<std::string>::make();
+    as.set_value(1);
+    bs.set_value("b");
+
+    std::string got;
+    std::size_t taken = select(case_(br, [&](std::string v) { got = v; }), case_(ar, [](int) { FAIL(); }));
+
+    EXPECT_EQ(taken, 0u);
+    EXPECT_EQ(got, "b");
+    EXPECT_TRUE(ar.ready());  // untouched
+}
+
+TEST(OneShotSelectTest, DefaultRunsWhenNothingIsReady) {
+    auto [s, r] = OneShot<int>::make();
+    bool fallback = false;
+    std::size_t taken = select(case_(r, [](int) { FAIL(); }), default_([&] { fallback = true; }));
+    EXPECT_EQ(taken, 1u);
+    EXPECT_TRUE(fallback);
+    EXPECT_TRUE(r);
+}
+
+TEST(OneShotSelectTest, TimeoutRunsWhenNothingCompletes) {
+    auto [rs, rr] = OneShot<int>::make();
+    auto [cs, cr] = OneShotChannel<void>::make();
+    bool timed_out = false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t taken = select(case_(rr, [](int) { FAIL(); }), case_(cr, [] { FAIL(); }),
+                               timeout(30ms, [&] { timed_out = true; }));
+
+    EXPECT_EQ(taken, 2u);
+    EXPECT_TRUE(timed_out);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 30ms);
+
+    // nodes were unlinked: completing afterwards touches nothing of select()
+    EXPECT_TRUE(rs.set_value(1));
+    EXPECT_TRUE(cs.set_value());
+    EXPECT_EQ(rr.get(), 1);
+}
+
+// --------------------------------------------------
+// Waiting on heterogeneous receivers
+// --------------------------------------------------
+
+TEST(OneShotSelectTest, WakesOnReplyFromAnotherThread) {
+    auto [rs, rr] = OneShot<std::string>::make();
+    auto [cs, cr] = OneShotChannel<void>::make();
+
+    std::thread replier([&rs = rs]() {
+        std::this_thread::sleep_for(20ms);
+        rs.set_value("reply");
+    });
+    std::string got;
+    std::size_t taken = select(case_(rr, [&](std::string v) { got = std::move(v); }), case_(cr, [] { FAIL(); }),
+                               timeout(5s, [] { FAIL() << "timed out"; }));
+    replier.join();
+
+    EXPECT_EQ(taken, 0u);
+    EXPECT_EQ(got, "reply");
+}
+
+TEST(OneShotSelectTest, WakesOnChannelCancel) {
+    auto [rs, rr] = OneShot<int>::make();
+    auto [cs, cr] = OneShotChannel<void>::make();
+
+    std::thread canceller([&cs = cs]() {
+        std::this_thread::sleep_for(20ms);
+        cs.set_value();
+    });
+    bool cancelled = false;
+    std::size_t taken = select(case_(rr, [](int) { FAIL(); }), case_(cr, [&] { cancelled = true; }));
+    canceller.join();
+
+    EXPECT_EQ(taken, 1u);
+    EXPECT_TRUE(cancelled);
+
+    // the channel stays usable: next generation, same select
+    EXPECT_TRUE(cr.reset());
+    cs.set_value();
+    EXPECT_EQ(select(case_(rr, [](int) {}), case_(cr, [] {})), 1u);
+}
+
+TEST(OneShotSelectTest, BrokenPromisePropagates) {
+    auto [rs, rr] = OneShot<int>::make();
+    auto [cs, cr] = OneShotChannel<int>::make();
+
+    std::thread dropper([s = std::move(rs)]() mutable {
+        std::this_thread::sleep_for(10ms);
+        s = {};
+    });
+    try {
+        select(case_(rr, [](int) { FAIL(); }), case_(cr, [](int) { FAIL(); }));
+        ADD_FAILURE() << "expected broken_promise";
+    } catch (const std::future_error& e) {
+        EXPECT_EQ(e.code(), std::make_error_code(std::future_errc::broken_promise));
+    }
+    dropper.join();
+}
+
+TEST(OneShotSelectTest, EmptyReceiversNeverBecomeReady) {
+    OneShot<int>::Receiver empty;
+    OneShotChannel<int>::Receiver empty_channel;
+    bool timed_out = false;
+    EXPECT_EQ(select(case_(empty, [](int) { FAIL(); }), case_(empty_channel, [](int) { FAIL(); }),
+                     timeout(5ms, [&] { timed_out = true; })),
+              2u);
+    EXPECT_TRUE(timed_out);
+}
+
+TEST(OneShotSelectTest, RacingCompletionsRunExactlyOneHandler) {
+    constexpr int kRounds = 300;
+    for (int i = 0; i < kRounds; ++i) {
+        auto [as, ar] = OneShot<int>::make();
+        auto [bs, br] = OneShotChannel<int>::make();
+        std::thread a([&as = as, i]() { as.set_value(i); });
+        std::thread b([&bs = bs, i]() { bs.set_value(-i); });
+
+        int handlers = 0;
+        int got = 0;
+        std::size_t taken = select(case_(ar, [&](int v) { ++handlers, got = v; }),
+                                   case_(br, [&](int v) { ++handlers, got = v; }));
+        a.join();
+        b.join();
+        EXPECT_EQ(handlers, 1);
+        EXPECT_EQ(got, taken == 0 ? i : -i);
+    }
+}
+
+// --------------------------------------------------
+// Quorum: when_n
+// --------------------------------------------------
+
+namespace {
+
+template<typename T>
+struct Replicas {
+    std::vector<typename OneShot<T>::Sender> senders;
+    std::vector<typename OneShot<T>::Receiver> receivers;
+
+    explicit Replicas(int n) {
+        for (int i = 0; i < n; ++i) {
+            auto [s, r] = OneShot<T>::make();
+            senders.push_back(std::move(s));
+            receivers.push_back(std::move(r));
+        }
+    }
+};
+
+} // namespace
+
+TEST(OneShotQuorumTest, FirstKValuesWinAndStragglersAreCancelled) {
+    Replicas<std::string> rep(3);
+    rep.senders[2].set_value("c");
+    rep.senders[0].set_value("a");
+
+    auto q = oneshot_select::when_n(2, rep.receivers);
+    EXPECT_TRUE(q.ok);
+    EXPECT_EQ(q.indices, (std::vector<std::size_t>{0, 2}));
+    EXPECT_EQ(q.values, (std::vector<std::string>{"a", "c"}));
+    EXPECT_TRUE(q.errors.empty());
+
+    EXPECT_FALSE(rep.receivers[1]);  // the straggler's receiver was dropped
+    EXPECT_TRUE(rep.senders[1].cancelled());
+    EXPECT_EQ(rep.senders[1].try_set_value("late"), std::optional<std::string>("late"));
+    EXPECT_FALSE(rep.senders[0].cancelled());
+}
+
+TEST(OneShotQuorumTest, GivesUpOnceTooManyFailed) {
+    Replicas<int> rep(3);
+    rep.senders[1].set_exception(std::make_exception_ptr(std::runtime_error("replica down")));
+    rep.senders[2] = {};  // broken promise
+
+    auto q = oneshot_select::when_n(2, rep.receivers);  // 2 of 3 can no longer succeed
+    EXPECT_FALSE(q.ok);
+    EXPECT_TRUE(q.indices.empty());
+    ASSERT_EQ(q.errors.size(), 2u);
+    EXPECT_EQ(q.errors[0].first, 1u);
+    EXPECT_THROW(std::rethrow_exception(q.errors[0].second), std::runtime_error);
+    EXPECT_EQ(q.errors[1].first, 2u);
+    EXPECT_THROW(std::rethrow_exception(q.errors[1].second), std::future_error);
+    EXPECT_TRUE(rep.senders[0].cancelled());
+}
+
+TEST(OneShotQuorumTest, EmptyReceiverCountsAsFailed) {
+    Replicas<int> rep(3);
+    { auto taken = std::move(rep.receivers[0]); }
+    rep.senders[1].set_exception(std::make_exception_ptr(std::runtime_error("replica down")));
+    rep.senders[2].set_value(7);
+
+    auto q = oneshot_select::when_n(2, rep.receivers);  // would never return if the empty one were skipped
+    EXPECT_FALSE(q.ok);
+    ASSERT_EQ(q.errors.size(), 2u);
+    EXPECT_EQ(q.errors[0].first, 0u);
+    try {
+        std::rethrow_exception(q.errors[0].second);
+        FAIL() << "expected future_error";
+    } catch (const std::future_error& e) {
+        EXPECT_EQ(e.code(), std::future_errc::no_state);
+    }
+    EXPECT_EQ(q.errors[1].first, 1u);
+}
+
+TEST(OneShotQuorumTest, MajorityOfFiveFromOtherThreads) {
+    Replicas<int> rep(5);
+    std::vector<std::thread> replies;
+    for (int i : {3, 0, 4}) {  // the other two never answer
+        replies.emplace_back([&rep, i] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2 * i));
+            rep.senders[i].set_value(10 * i);
+        });
+    }
+    auto q = oneshot_select::when_n(3, rep.receivers);
+    for (auto& t : replies) t.join();
+
+    EXPECT_TRUE(q.ok);
+    ASSERT_EQ(q.indices.size(), 3u);
+    for (std::size_t j = 0; j < q.indices.size(); ++j) EXPECT_EQ(q.values[j], 10 * int(q.indices[j]));
+    EXPECT_TRUE(rep.senders[1].cancelled());
+    EXPECT_TRUE(rep.senders[2].cancelled());
+}
+
+TEST(OneShotQuorumTest, StragglerWaitingForItsValueToBeTakenIsReleased) {
+    Replicas<int> rep(2);
+    rep.senders[0].set_value(1);
+    RendezvousResult late = RendezvousResult::Rejected;
+    std::thread slow([&rep, &late] {
+        std::this_thread::sleep_for(5ms);
+        late = rep.senders[1].set_value_and_wait(2);
+    });
+    auto q = oneshot_select::when_n(1, rep.receivers);
+    slow.join();
+    EXPECT_TRUE(q.ok);
+    EXPECT_EQ(q.indices, (std::vector<std::size_t>{0}));
+    EXPECT_EQ(late, RendezvousResult::ReceiverGone);
+}
+
+TEST(OneShotQuorumTest, VoidReceiversAndBadQuorumSizes) {
+    Replicas<void> rep(2);
+    rep.senders[1].set_value();
+    auto q = oneshot_select::when_n(1, rep.receivers);
+    EXPECT_TRUE(q.ok);
+    EXPECT_EQ(q.indices, (std::vector<std::size_t>{1}));
+
+    Replicas<int> more(2);
+    EXPECT_THROW(oneshot_select::when_n(0, more.receivers), std::invalid_argument);
+    EXPECT_THROW(oneshot_select::when_n(3, more.receivers), std::invalid_argument);
+}
+
+TEST(OneShotQuorumTest, RacingRepliesWakeOnceWithAQuorum) {
+    constexpr int kRounds = 200;
+    for (int round = 0; round < kRounds; ++round) {
+        Replicas<int> rep(3);
+        std::vector<std::thread> replies;
+        for (int i = 0; i < 3; ++i) replies.emplace_back([&rep, i] { rep.senders[i].set_value(i); });
+        auto q = oneshot_select::when_n(2, rep.receivers);
+        for (auto& t : replies) t.join();
+        EXPECT_TRUE(q.ok);
+        EXPECT_GE(q.indices.size(), 2u);
+        for (std::size_t j = 0; j < q.indices.size(); ++j) EXPECT_EQ(q.values[j], int(q.indices[j]));
+    }
+}
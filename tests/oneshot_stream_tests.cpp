@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "alloc_counter.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotStream.hpp"
+
+namespace {
+
+// Eager, fire-and-forget coroutine: runs until its first suspension, then
+// wherever it is resumed; the frame is freed when the body finishes.
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+template<typename Receiver, typename T>
+Task collect(Receiver& rx, std::vector<T>& out, std::atomic<bool>& done) {
+    auto values = oneshot_stream::stream(rx);
+    while (auto v = co_await values.next()) out.push_back(*v);
+    done = true;
+}
+
+} // namespace
+
+// --------------------------------------------------
+// Values, end of stream
+// --------------------------------------------------
+
+TEST(OneShotStreamTest, YieldsEachValueInOrderThenEndsWhenSenderDrops) {
+    auto [tx, rx] = OneShotChannel<int>::make();
+    std::vector<int> got;
+    std::atomic<bool> done{false};
+    collect(rx, got, done);
+    EXPECT_TRUE(got.empty());  // suspended: nothing set yet
+
+    std::thread producer([tx = std::move(tx)]() mutable {
+        for (int i = 0; i < 1000; ++i) {
+            while (!tx.set_value(i)) std::this_thread::yield();  // previous value not taken yet
+        }
+    });
+    producer.join();
+
+    // the consumer runs on the producer's thread, so it has seen the drop
+    EXPECT_TRUE(done);
+    ASSERT_EQ(got.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) EXPECT_EQ(got[i], i);
+}
+
+TEST(OneShotStreamTest, ValueSetBeforeAwaitIsTakenWithoutSuspending) {
+    auto [tx, rx] = OneShotChannel<std::string>::make();
+    tx.set_value("first");
+    std::vector<std::string> got;
+    std::atomic<bool> done{false};
+    collect(rx, got, done);
+
+    ASSERT_EQ(got.size(), 1u);
+    EXPECT_EQ(got[0], "first");
+    EXPECT_TRUE(tx.set_value("second"));  // the stream re-armed the channel
+    EXPECT_EQ(got.size(), 2u);
+    EXPECT_FALSE(done);
+}
+
+TEST(OneShotStreamTest, LastValueIsYieldedBeforeTheEnd) {
+    auto [tx, rx] = OneShotChannel<int>::make();
+    tx.set_value(7);
+    { auto gone = std::move(tx); }
+    std::vector<int> got;
+    std::atomic<bool> done{false};
+    collect(rx, got, done);
+
+    EXPECT_EQ(got, std::vector<int>{7});
+    EXPECT_TRUE(done);
+}
+
+TEST(OneShotStreamTest, VoidStreamYieldsEachSignal) {
+    auto [tx, rx] = OneShotChannel<void>::make();
+    int signals = 0;
+    std::atomic<bool> done{false};
+    [](auto& rx, int& signals, std::atomic<bool>& done) -> Task {
+        auto s = oneshot_stream::stream(rx);
+        while (co_await s.next()) ++signals;
+        done = true;
+    }(rx, signals, done);
+
+    for (int i = 0; i < 3; ++i) EXPECT_TRUE(tx.set_value());
+    EXPECT_EQ(signals, 3);
+    EXPECT_FALSE(done);
+    { auto gone = std::move(tx); }
+    EXPECT_TRUE(done);
+}
+
+// --------------------------------------------------
+// Exceptions, destruction
+// --------------------------------------------------
+
+TEST(OneShotStreamTest, ExceptionIsRethrownAndTheStreamContinues) {
+    auto [tx, rx] = OneShotChannel<int>::make();
+    std::vector<std::string> events;
+    [](auto& rx, std::vector<std::string>& events) -> Task {
+        auto s = oneshot_stream::stream(rx);
+        for (;;) {
+            try {
+                auto v = co_await s.next();
+                if (!v) break;
+                events.push_back(std::to_string(*v));
+            } catch (const std::runtime_error& e) {
+                events.push_back(e.what());
+            }
+        }
+        events.push_back("end");
+    }(rx, events);
+
+    tx.set_value(1);
+    tx.set_exception(std::make_exception_ptr(std::runtime_error("boom")));
+    tx.set_value(2);
+    { auto gone = std::move(tx); }
+    EXPECT_EQ(events, (std::vector<std::string>{"1", "boom", "2", "end"}));
+}
+
+TEST(OneShotStreamTest, DestroyingASuspendedCoroutineUnlinksItsWaiter) {
+    struct Lazy {
+        struct promise_type {
+            Lazy get_return_object() noexcept { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+        std::coroutine_handle<promise_type> h;
+    };
+
+    auto [tx, rx] = OneShotChannel<int>::make();
+    int got = 0;
+    Lazy task = [](auto& rx, int& got) -> Lazy {
+        auto s = oneshot_stream::stream(rx);
+        while (auto v = co_await s.next()) got = *v;
+    }(rx, got);
+
+    task.h.destroy();  // suspended in next(): the Stream unlinks its node
+    EXPECT_TRUE(tx.set_value(1));
+    EXPECT_EQ(got, 0);
+}
+
+// --------------------------------------------------
+// Allocations
+// --------------------------------------------------
+
+TEST(OneShotStreamTest, SteadyStateAllocatesNothingPerElement) {
+    auto [tx, rx] = OneShotChannel<int>::make();
+    std::vector<int> got;
+    got.reserve(64);
+    std::atomic<bool> done{false};
+    collect(rx, got, done);
+
+    EXPECT_ALLOCATIONS(0, {
+        for (int i = 0; i < 32; ++i) tx.set_value(i);
+    });
+    EXPECT_EQ(got.size(), 32u);
+}
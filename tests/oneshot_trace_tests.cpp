@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include "OneShotFuture.hpp"
+#include "OneShotChannel.hpp"
+#include "OneShotTrace.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::size_t count(const std::string& haystack, const std::string& needle) {
+    std::size_t n = 0;
+    for (auto pos = haystack.find(needle); pos != std::string::npos; pos = haystack.find(needle, pos + 1)) ++n;
+    return n;
+}
+
+std::size_t registered_rings() {
+    auto& reg = oneshot_trace::registry();
+    std::lock_guard<std::mutex> lock(reg.mtx);
+    return reg.rings.size();
+}
+
+void trace_on_new_thread() {
+    std::thread([] {
+        auto [s, r] = OneShot<int, TraceObserver>::make();
+        s.set_value(1);
+        r.get();
+    }).join();
+}
+
+} // namespace
+
+// --------------------------------------------------
+// Trace export tests
+// --------------------------------------------------
+
+TEST(OneShotTraceTest, RecordsLifecycleAcrossThreads) {
+    oneshot_trace::clear();
+    {
+        oneshot_trace::ScopedLabel label("fetch \"user\"");
+        auto [s, r] = OneShot<int, TraceObserver>::make();
+        std::thread producer([s = std::move(s)]() mutable {
+            std::this_thread::sleep_for(5ms);
+            s.set_value(1);
+        });
+        EXPECT_EQ(r.get(), 1);
+        producer.join();
+    }
+
+    std::ostringstream os;
+    oneshot_trace::write_chrome_json(os);
+    std::string json = os.str();
+
+    EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_EQ(count(json, "\"name\":\"make\""), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"set\""), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"wake\""), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"consume\""), 1u);
+    EXPECT_EQ(count(json, "\"label\":\"fetch \\\"user\\\"\""), 4u);  // escaped
+    // one flow from the producer's set to the consumer's wake
+    EXPECT_EQ(count(json, "\"ph\":\"s\""), 1u);
+    EXPECT_EQ(count(json, "\"ph\":\"f\""), 1u);
+}
+
+TEST(OneShotTraceTest, ChannelGenerationsAreSeparateFlows) {
+    oneshot_trace::clear();
+    auto [s, r] = OneShotChannel<void, TraceObserver>::make();
+    s.set_value();
+    r.get();
+    r.reset();
+    EXPECT_FALSE(r.get_for(1ms));
+
+    std::ostringstream os;
+    oneshot_trace::write_chrome_json(os);
+    std::string json = os.str();
+
+    EXPECT_EQ(count(json, "\"name\":\"reset\""), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"timeout\""), 1u);
+    auto make = json.find("\"name\":\"make\"");
+    auto after_reset = json.find("\"name\":\"timeout\"");
+    ASSERT_NE(make, std::string::npos);
+    ASSERT_NE(after_reset, std::string::npos);
+    auto id_of = [&](std::size_t pos) { return json.substr(json.find("\"id\":", pos), 12); };
+    EXPECT_NE(id_of(make), id_of(after_reset));
+}
+
+TEST(OneShotTraceTest, ClearDropsRecordedEvents) {
+    {
+        auto [s, r] = OneShot<void, TraceObserver>::make();
+        s.set_value();
+        r.get();
+    }
+    oneshot_trace::clear();
+
+    std::ostringstream os;
+    oneshot_trace::write_chrome_json(os);
+    EXPECT_EQ(os.str().find("\"name\":"), std::string::npos);
+}
+
+TEST(OneShotTraceTest, ExportWhileTheRingWrapsSkipsTornEvents) {
+    oneshot_trace::clear();
+    std::atomic<bool> stop{false};
+    std::thread recorder([&stop] {
+        oneshot_trace::ScopedLabel label("spin");
+        while (!stop.load()) {
+            auto [s, r] = OneShot<void, TraceObserver>::make();
+            s.set_value();
+            r.get();
+        }
+    });
+    for (int i = 0; i < 20; ++i) {
+        std::ostringstream os;
+        oneshot_trace::write_chrome_json(os);
+        std::string json = os.str();
+        // every exported slice is whole: a known name and the recorder's label
+        EXPECT_EQ(count(json, "\"cat\":\"oneshot\",\"ph\":\"X\""), count(json, "\"label\":\"spin\""));
+        EXPECT_EQ(count(json, "\"name\":\"?\""), 0u);
+    }
+    stop = true;
+    recorder.join();
+}
+
+TEST(OneShotTraceTest, RingOfAnExitedThreadIsReleasedOnceWritten) {
+    oneshot_trace::clear();  // also releases rings left by earlier tests
+    std::size_t live = registered_rings();
+
+    trace_on_new_thread();
+    EXPECT_EQ(registered_rings(), live + 1);  // its events are not written yet
+
+    std::ostringstream os;
+    oneshot_trace::write_chrome_json(os);
+    EXPECT_EQ(count(os.str(), "\"name\":\"set\""), 1u);
+    EXPECT_EQ(registered_rings(), live);
+}
+
+TEST(OneShotTraceTest, UnwrittenRingsOfExitedThreadsAreCapped) {
+    oneshot_trace::clear();
+    std::size_t live = registered_rings();
+    for (std::size_t i = 0; i < oneshot_trace::Registry::kMaxExited + 8; ++i) trace_on_new_thread();
+    // each new ring prunes down to the cap before it registers
+    EXPECT_LE(registered_rings(), live + oneshot_trace::Registry::kMaxExited + 1);
+    oneshot_trace::clear();
+    EXPECT_EQ(registered_rings(), live);
+}
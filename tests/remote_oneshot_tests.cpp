@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "RemoteOneShot.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+std::pair<int, int> make_socketpair() {
+    int fds[2];
+    EXPECT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    return {fds[0], fds[1]};
+}
+
+struct Point {
+    int x;
+    int y;
+};
+
+// Length-prefixed vector<int>, to exercise a user-supplied codec
+struct IntVectorCodec {
+    static void encode(const std::vector<int>& v, std::string& out) {
+        out.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(int));
+    }
+    static std::vector<int> decode(const char* data, std::size_t len) {
+        std::vector<int> v(len / sizeof(int));
+        std::memcpy(v.data(), data, len);
+        return v;
+    }
+};
+
+} // namespace
+
+// --------------------------------------------------
+// RemoteOneShot tests
+// --------------------------------------------------
+
+TEST(RemoteOneShotTest, ValueRoundTrip) {
+    auto [local, remote] = make_socketpair();
+    RemoteOneShotEndpoint endpoint(local);
+    RemoteOneShotCompleter completer(remote);
+
+    auto [token, r] = endpoint.make<Point>();
+    auto shipped = token.serialize();
+
+    auto s = completer.attach<Point>(RemoteToken::parse(shipped));
+    EXPECT_TRUE(s.set_value(Point{3, 4}));
+    EXPECT_FALSE(s.set_value(Point{5, 6}));
+    EXPECT_EQ(completer.flush(), 1u);
+
+    auto p = r.get();
+    EXPECT_EQ(p.x, 3);
+    EXPECT_EQ(p.y, 4);
+}
+
+TEST(RemoteOneShotTest, BatchOfCompletionsInOneFlush) {
+    auto [local, remote] = make_socketpair();
+    RemoteOneShotEndpoint endpoint(local);
+    RemoteOneShotCompleter completer(remote);
+
+    constexpr int kCount = 512;
+    std::vector<OneShot<int>::Receiver> receivers;
+    std::vector<RemoteOneShotCompleter::Sender<int>> senders;
+    for (int i = 0; i < kCount; ++i) {
+        auto [token, r] = endpoint.make<int>();
+        receivers.push_back(std::move(r));
+        senders.push_back(completer.attach<int>(token));
+    }
+    for (int i = 0; i < kCount; ++i) senders[i].set_value(i * 2);
+
+    EXPECT_FALSE(receivers.front().wait_for(10ms));  // nothing written yet
+    EXPECT_EQ(completer.flush(), static_cast<std::size_t>(kCount));
+    for (int i = 0; i < kCount; ++i) EXPECT_EQ(receivers[i].get(), i * 2);
+    EXPECT_EQ(endpoint.pending(), 0u);
+}
+
+TEST(RemoteOneShotTest, CustomCodecAndString) {
+    auto [local, remote] = make_socketpair();
+    RemoteOneShotEndpoint endpoint(local);
+    RemoteOneShotCompleter completer(remote);
+
+    auto [t1, r1] = endpoint.make<std::vector<int>, IntVectorCodec>();
+    auto [t2, r2] = endpoint.make<std::string>();
+    completer.attach<std::vector<int>, IntVectorCodec>(t1).set_value(std::vector<int>{1, 2, 3});
+    completer.attach<std::string>(t2).set_value(std::string("hello"));
+    completer.flush();
+
+    EXPECT_EQ(r1.get(), (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(r2.get(), "hello");
+}
+
+TEST(RemoteOneShotTest, EmptyPayloads) {
+    auto [local, remote] = make_socketpair();
+    RemoteOneShotEndpoint endpoint(local);
+    RemoteOneShotCompleter completer(remote);
+
+    auto [t1, r1] = endpoint.make<std::string>();
+    auto [t2, r2] = endpoint.make<void>();
+    EXPECT_TRUE(completer.attach<std::string>(t1).set_value(std::string()));
+    EXPECT_TRUE(completer.attach<void>(t2).set_value());
+    completer.flush();
+
+    EXPECT_EQ(r1.get(), "");
+    EXPECT_NO_THROW(r2.get());
+}
+
+TEST(RemoteOneShotTest, OversizedFrameIsRejectedBeforeWriting) {
+    if (sizeof(std::size_t) <= sizeof(std::uint32_t)) GTEST_SKIP() << "every length fits";
+    // the length is checked before the payload is read, so no 4 GiB buffer is needed
+    std::string out = "queued";
+    char byte = 0;
+    std::size_t len = std::size_t(std::numeric_limits<std::uint32_t>::max()) + 1;
+    EXPECT_THROW(remote_oneshot_detail::append_frame(out, 1, remote_oneshot_detail::Value, &byte, len),
+                 std::length_error);
+    EXPECT_EQ(out, "queued");
+}
+
+TEST(RemoteOneShotTest, ExceptionAndDroppedSender) {
+    auto [local, remote] = make_socketpair();
+    RemoteOneShotEndpoint endpoint(local);
+    RemoteOneShotCompleter completer(remote);
+
+    auto [t1, r1] = endpoint.make<int>();
+    auto [t2, r2] = endpoint.make<void>();
+    completer.attach<int>(t1).set_exception(std::make_exception_ptr(std::runtime_error("bad")));
+    { auto dropped = completer.attach<void>(t2); }
+    completer.flush();
+
+    try {
+        r1.get();
+        FAIL() << "expected RemoteOneShotError";
+    } catch (const RemoteOneShotError& e) {
+        EXPECT_STREQ(e.what(), "bad");
+    }
+    EXPECT_THROW(r2.get(), std::future_error);
+}
+
+TEST(RemoteOneShotTest, DisconnectBreaksPending) {
+    auto [local, remote] = make_socketpair();
+    RemoteOneShotEndpoint endpoint(local);
+
+    auto [token, r] = endpoint.make<int>();
+    {
+        RemoteOneShotCompleter completer(remote);
+    }
+    EXPECT_THROW(r.get(), std::future_error);
+    EXPECT_FALSE(endpoint.connected());
+
+    auto [late, r2] = endpoint.make<int>();
+    EXPECT_THROW(r2.get(), std::future_error);
+}
+
+TEST(RemoteOneShotTest, CompletesFromForkedProcess) {
+    auto [local, remote] = make_socketpair();
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        ::close(local);
+        RemoteOneShotCompleter completer(remote);
+        char buf[16];
+        // the token arrives in-band here only to keep the test self-contained
+        if (::recv(remote, buf, sizeof(buf), MSG_WAITALL) == 16) {
+            completer.attach<void>(RemoteToken::parse(std::string(buf, 16))).set_value();
+        }
+        completer.flush();
+        ::_exit(0);
+    }
+    ::close(remote);
+    int token_fd = ::dup(local);
+    RemoteOneShotEndpoint endpoint(local);
+    auto made = endpoint.make<void>();
+    auto shipped = made.first.serialize();
+    ASSERT_EQ(::send(token_fd, shipped.data(), shipped.size(), 0), 16);
+
+    made.second.get();
+    ::close(token_fd);
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    EXPECT_EQ(status, 0);
+}